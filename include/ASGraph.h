@@ -1,38 +1,257 @@
 #pragma once
 #include "ASNode.h"
-#include <unordered_map>
-#include <string>
+#include "PathStore.h"
+#include "PrefixTable.h"
+#include "Profiler.h"
+#include "RibSpill.h"
+#include "RouteDelta.h"
+#include "ThreadPool.h"
+#include "Topology.h"
 #include <functional>
+#include <memory>
+#include <string>
+#include <set>
+#include <vector>
+
+enum class PropagationEngine {
+    PUSH,  // senders copy routes into receive queues (reference implementation)
+    PULL   // receivers read their neighbors' finalized RIBs directly
+};
 
 class ASGraph {
 public:
-    std::unordered_map<int, ASNodePtr> nodes;
-    std::vector<std::vector<int>> propagationRanks;
+    Topology topology;
+    std::vector<ASNode> nodes;  // indexed like topology
+    std::vector<std::vector<uint32_t>> propagationRanks;  // node indices per rank
+    PrefixTable prefixes;  // interned from seeded announcements
+    PathStore paths;       // shared storage for every RIB entry's AS path
+    PropagationEngine engine = PropagationEngine::PUSH;
+    Profiler* profiler = nullptr;  // per-rank timings and route counts when set
 
-    ASNodePtr getOrCreateNode(int asn);
+    ASNode* findNode(int asn);
     void addRelationship(int as1, int as2, int relationship);
+    void buildTopology();
     bool loadFromFile(const std::string& filename);
     bool hasProviderCycle();
     bool hasCustomerCycle();
+    // On a cycle, fills in its ASNs with each AS a provider of the next; the
+    // first ASN is repeated at the end
+    bool findProviderCycle(std::vector<int>& cycle) const;
     void printStats();
 
+    // Binary snapshot of the frozen topology and its propagation ranks
+    // (TopologySnapshot.cpp). Save after flattenGraph(); a loaded snapshot
+    // is ready for initializeBGPPolicies() with no further preprocessing.
+    bool saveTopology(const std::string& filename) const;
+    bool loadTopology(const std::string& filename);
+
+    // Batch runs: take another graph's frozen topology and ranks without
+    // re-parsing, and drop policies, RIBs, prefixes and paths between runs
+    void copyTopology(const ASGraph& source);
+    void resetRoutingState();
+
     // BGP functionality
     void flattenGraph();
+    void printRankStats() const;  // how many ASes each rank can process in parallel
     void initializeBGPPolicies();
     void initializeBGPPolicies(const std::set<int>& rovASNs);
-    void seedAnnouncement(int asn, const std::string& prefix);
-    void propagateAnnouncements();
-    void outputToCSV(const std::string& filename);
+    void classifyPolicies();  // call again after replacing a node's policy by hand
+    void seedAnnouncement(int asn, const std::string& prefix, bool rovInvalid = false);
+    bool propagateAnnouncements();  // false if the path store ran out of room
+    // Both reject a configuration needing more than PathStore::MAX_SHARDS
+    // path shards (threads times prefix shards) and keep the current one
+    bool setThreadCount(unsigned threads);  // call before seeding announcements
+    // Propagate disjoint prefix ranges concurrently, each on its own thread
+    // with threadCount() workers (PrefixSharding.cpp). Built-in BGP/ROV
+    // policies only; graphs with custom policies propagate unsharded.
+    // Call before seeding announcements.
+    bool setPrefixShards(unsigned shards);
+    unsigned threadCount() const { return pool ? pool->size() : 1; }
+
+    // Implicit stub RIBs (ImplicitStubs.cpp): a stub AS with one provider,
+    // no customers or peers and no seeds routes exactly like its provider,
+    // so propagation skips it and its rows are derived from the provider's
+    // RIB at output. Call before propagating; turning it off, or
+    // materializeImplicitRIBs(), gives every stub a real RIB again.
+    void setImplicitStubs(bool enabled);
+    void materializeImplicitRIBs();
+    bool hasImplicitRIB(uint32_t index) const { return index < implicitRIB.size() && implicitRIB[index]; }
+    size_t routeCount() const;  // every RIB entry, implicit ones included
+    // The route the AS at index holds for prefixId, or nullptr. An implicit
+    // stub gets its provider's entry, whose path does not include the stub.
+    const Announcement* routeFor(uint32_t index, PrefixId prefixId) const;
+
+    // Memory-budgeted runs (RibSpill.cpp): in the downward pass, once an AS
+    // is no longer read as a sender and the RIBs held exceed budgetBytes,
+    // its rows are written to spillFile and its RIB is freed. outputToCSV
+    // splices them back in, so the file matches an unbudgeted run. CSV
+    // output only, and no deltas or prefix sharding on a spilled graph.
+    // Budgeted runs always use the pull engine: push keeps the path node of
+    // every route alive, so freeing RIBs alone saves little.
+    void setMemoryBudget(size_t budgetBytes, const std::string& spillFile);
+    uint64_t spilledRoutes() const;
+
+    bool outputToCSV(const std::string& filename);
+    bool outputToBinary(const std::string& filename) const;  // layout in RibFormat.h
+
+    // Incremental re-propagation (RouteDelta.cpp): apply seed and policy
+    // changes to converged RIBs, re-propagating only the affected prefixes.
+    // Returns false if any change could not be applied (the rest still are)
+    // or if propagation failed; paths.full() tells the two apart.
+    bool applyDelta(const RouteDelta& delta);
 
     // ROV functionality
     bool loadAnnouncementsFromCSV(const std::string& filename);
     bool loadROVASNs(const std::string& filename, std::set<int>& rovASNs);
 
 private:
-    bool hasCycleDFS(int start, std::set<int>& visited, std::set<int>& recStack,
-                     const std::function<const std::set<int>&(const ASNodePtr&)>& getNeighbors);
+    using NeighborFn = NeighborRange (Topology::*)(uint32_t) const;
+
+    std::vector<RelationshipEdge> pendingEdges;
+
+    // Every origin route seeded since policies were initialized, so affected
+    // prefixes can be re-seeded after a delta. Each loaded file is sorted by
+    // origin and prefix (SeedLoader.cpp); repeated rows keep their order.
+    struct Seed {
+        uint32_t index;
+        PrefixId prefixId;
+        bool rovInvalid;
+    };
+    std::vector<Seed> seeds;
+    void seedInBulk(std::vector<Seed>& loaded);
+
+    // Prefix sharding: a shard graph prepends into its parent's path store,
+    // in the block of shards starting at pathShardBase
+    unsigned prefixShardCount = 1;
+    PathStore* sharedPaths = nullptr;
+    unsigned pathShardBase = 0;
+
+    // Marked once per routing state, on the first propagation, so delta
+    // re-propagation over set-aside RIBs cannot change which stubs qualify
+    bool implicitStubs = false;
+    std::vector<uint8_t> implicitRIB;  // per node index; empty until marked
+    void markImplicitStubs();
+    void materializeImplicitRIB(uint32_t index, PathShard& shard);
+    const RIB& providerRIB(uint32_t stub) const { return bgpPolicies[*topology.providers(stub).begin()]->localRIB; }
+    bool inheritsRoute(uint32_t stub, const Announcement& route) const {
+        return route.nextHopASN != nodes[stub].asn && !(policyKinds[stub] == PolicyKind::ROV && route.rovInvalid);
+    }
+
+    bool pathShardsFit(unsigned threads, unsigned shards) const;
+    void resetPaths();
+    PathShard& pathShard(unsigned worker) {
+        return (sharedPaths ? *sharedPaths : paths).shard(pathShardBase + worker);
+    }
+    void propagateByPrefixShard();
+    std::unique_ptr<ThreadPool> pool;
+
+    // Policy dispatch, resolved once per node instead of per announcement
+    struct PolicyGroups {
+        std::vector<uint32_t> bgp;
+        std::vector<uint32_t> rov;
+        std::vector<uint32_t> custom;
+    };
+    std::vector<PolicyKind> policyKinds;  // per node index
+    std::vector<BGP*> bgpPolicies;        // per node index, nullptr unless BGP-based
+    std::vector<PolicyGroups> rankGroups; // propagationRanks split by policy kind
+    PolicyGroups allGroups;               // every node split by policy kind
+
+    void groupByPolicy();
+    static void addToGroup(PolicyGroups& groups, PolicyKind kind, uint32_t index);
+
+    // Delta re-propagation (RouteDelta.cpp) runs only the ASes its prefixes
+    // can reach; every engine walks these lists instead while it is scoped
+    bool scopedToRegion = false;
+    std::vector<uint32_t> regionNodes;               // ascending node indices
+    std::vector<std::vector<uint32_t>> regionRanks;  // regionNodes split by rank
+    const std::vector<std::vector<uint32_t>>& ranksToRun() const {
+        return scopedToRegion ? regionRanks : propagationRanks;
+    }
+    bool valleyFreeReach(const std::vector<uint32_t>& origins, size_t limit, std::vector<uint32_t>& region) const;
+
+    // Memory-budgeted runs (RibSpill.cpp)
+    size_t memoryBudget = 0;
+    std::string spillFilename;  // empty: never spill
+    std::unique_ptr<RibSpill> spill;  // opened on the first spill
+    // A downward step runs as one or more windows, wide ranks being split;
+    // after each, the listed nodes are done
+    struct SpillWindow {
+        PolicyGroups receivers;
+        std::vector<uint32_t> released;
+    };
+    std::vector<std::vector<SpillWindow>> spillWindows;  // per rank
+    std::vector<uint32_t> spillPending;  // done but still held, waiting for the budget to run out
+    // Leaves whose down-pass routes keep the sender's path: nothing reads a
+    // leaf's paths before its rows are written, so no path nodes are made
+    std::vector<uint8_t> ownerHopDeferred;  // per node index; empty unless budgeted
+    bool spillFailed = false;  // a spill write failed; the rest stays in memory
+    bool defersOwnerHop(uint32_t index) const { return index < ownerHopDeferred.size() && ownerHopDeferred[index]; }
+    void planSpill();
+    void releaseNodes(const std::vector<uint32_t>& indices);
+    void spillNodes(const std::vector<uint32_t>& indices);
+    size_t rowCount(uint32_t index) const;  // output rows, spilled or implicit ones included
+
+    // Shared by cycle detection and flattenGraph (one O(V+E) pass)
+    uint32_t layerByCustomers(std::vector<uint32_t>& order, std::vector<uint32_t>& rank) const;
+
+    // Work is split by receiver: worker w owns every node with index % workers == w,
+    // so each RIB and receive queue is only ever touched by one thread.
+    bool ownedBy(uint32_t index, unsigned worker) const { return index % threadCount() == worker; }
+    void runWorkers(const std::function<void(unsigned)>& task);
+    RouteCounts enqueueFrom(uint32_t sender, uint32_t receiver, Relationship relationship, unsigned worker);
+    RouteCounts offerToPolicy(uint32_t sender, uint32_t receiver, Relationship relationship);
+    void processReceived(uint32_t index, PathShard& shard, unsigned worker);
+    std::vector<std::vector<std::vector<Announcement>>> queuePools;  // per worker, spare receive queues
+    void borrowQueue(std::vector<Announcement>& queue, unsigned worker);
+    void returnQueue(std::vector<Announcement>& queue, unsigned worker);
+
+    // Output (RibOutput.cpp)
+    // How the paths stored in a RIB relate to the rows written for a node
+    enum class RowPaths {
+        OWN,            // the node's RIB with complete paths
+        INHERITED,      // the provider's RIB of an implicit stub
+        OWNER_DEFERRED  // the node's RIB, paths still missing its own ASN
+    };
+    // False if the rows had been spilled and cannot be read back
+    bool appendRibRows(uint32_t index, std::string& out, std::vector<int>& hops) const;
+    void appendRows(uint32_t index, const RIB& rib, RowPaths source, std::string& out, std::vector<int>& hops) const;
+
+    // The edges of one push step or of the peer phase, grouped by receiver.
+    // Only edges whose sender holds routes are listed, so workers walk these
+    // instead of every node. Receivers are split into contiguous slices of
+    // roughly equal work, one per worker, so each edge is visited once.
+    struct ReceiverEdges {
+        std::vector<uint32_t> receivers;      // node indices, each listed once
+        std::vector<uint32_t> senderOffsets;  // receivers.size() + 1 entries into senders
+        std::vector<uint32_t> senders;        // one entry per edge that carries routes
+        std::vector<size_t> workerSlices;     // threadCount() + 1 bounds into receivers
+
+        NeighborRange sendersOf(size_t slot) const {
+            return {senders.data() + senderOffsets[slot], senders.data() + senderOffsets[slot + 1]};
+        }
+    };
+    ReceiverEdges collectPeerEdges() const;
+    ReceiverEdges collectRankEdges(const std::vector<uint32_t>& senders, NeighborFn receiversOf);
+    void sliceByWork(ReceiverEdges& edges, const std::vector<size_t>& work) const;
+    std::vector<uint32_t> edgeSlots;  // per node, its slot while collecting rank edges
+    void pushAlong(const ReceiverEdges& edges, Relationship relationship);
 
     void propagateUpward();
     void propagateAcross();
     void propagateDownward();
+
+    // Pull engine (PullPropagation.cpp). Built-in policies fold routes in
+    // directly; custom ones are offered them through the Policy interface.
+    template <PolicyKind Kind>
+    RouteCounts pullInto(RIB& target, uint32_t receiver, NeighborRange senders, Relationship relationship,
+                         PathShard& shard, bool prependOwner = true);
+    RouteCounts offerToCustom(uint32_t receiver, NeighborRange senders, Relationship relationship);
+    template <PolicyKind Kind>
+    void pullGroup(const std::vector<uint32_t>& receivers, NeighborFn sendersOf,
+                   Relationship relationship, unsigned worker);
+    void pullFromNeighbors(const PolicyGroups& receivers, NeighborFn sendersOf,
+                           Relationship relationship, unsigned worker);
+    void pullUpward();
+    void pullAcross();
+    void pullDownward();
 };
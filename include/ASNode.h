@@ -1,17 +1,12 @@
 #pragma once
-#include <vector>
 #include <memory>
-#include <set>
 #include "Policy.h"
-class ASNode;
-using ASNodePtr = std::shared_ptr<ASNode>;
 
+// Per-AS routing state. Adjacency lives in ASGraph::topology and is
+// addressed by the node's dense index.
 class ASNode {
 public:
     int asn;
-    std::set<int> providers;
-    std::set<int> customers;
-    std::set<int> peers;
     int propagationRank;
     std::unique_ptr<Policy> policy;
 
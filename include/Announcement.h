@@ -1,6 +1,7 @@
 #pragma once
-#include <string>
-#include <vector>
+#include "PathStore.h"
+#include "PrefixTable.h"
+#include <cstdint>
 
 enum class Relationship {
     ORIGIN = 0,      // Best - our own announcement
@@ -11,18 +12,34 @@ enum class Relationship {
 
 class Announcement {
 public:
-    std::string prefix;
-    std::vector<int> asPath;
+    PrefixId prefixId;
+    PathRef asPath;        // node in the graph's PathStore
+    uint32_t pathLength;   // cached length of asPath
     int nextHopASN;
     Relationship receivedFrom;
     bool rovInvalid;
 
-    Announcement(const std::string& prefix, const std::vector<int>& asPath,
+    Announcement(PrefixId prefixId, PathRef asPath, uint32_t pathLength,
                 int nextHopASN, Relationship receivedFrom, bool rovInvalid = false)
-        : prefix(prefix), asPath(asPath), nextHopASN(nextHopASN), receivedFrom(receivedFrom), rovInvalid(rovInvalid) {}
+        : prefixId(prefixId), asPath(asPath), pathLength(pathLength), nextHopASN(nextHopASN),
+          receivedFrom(receivedFrom), rovInvalid(rovInvalid) {}
 
-    Announcement() : nextHopASN(0), receivedFrom(Relationship::ORIGIN), rovInvalid(false) {}
+    Announcement()
+        : prefixId(0), asPath(PathStore::EMPTY), pathLength(0), nextHopASN(0),
+          receivedFrom(Relationship::ORIGIN), rovInvalid(false) {}
 
     Announcement createPropagated(int senderASN, Relationship rel) const;
-    bool isBetterThan(const Announcement& other) const;
+    bool isBetterThan(const Announcement& other) const { return decisionKey() < other.decisionKey(); }
+
+    // The whole decision process packed into one integer that sorts like it,
+    // lower is better: relationship (2 bits), then path length (30 bits),
+    // then next-hop ASN with its sign bit flipped to keep signed order
+    uint64_t decisionKey() const { return decisionKey(receivedFrom, pathLength, nextHopASN); }
+    static uint64_t decisionKey(Relationship receivedFrom, uint32_t pathLength, int nextHopASN) {
+        return (static_cast<uint64_t>(receivedFrom) << 62) | (static_cast<uint64_t>(pathLength) << 32) |
+               (static_cast<uint32_t>(nextHopASN) ^ 0x80000000u);
+    }
+    static Relationship keyRelationship(uint64_t key) { return static_cast<Relationship>(key >> 62); }
+    static uint32_t keyPathLength(uint64_t key) { return static_cast<uint32_t>(key >> 32) & 0x3FFFFFFFu; }
+    static int keyNextHopASN(uint64_t key) { return static_cast<int>(static_cast<uint32_t>(key) ^ 0x80000000u); }
 };
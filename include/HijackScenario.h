@@ -0,0 +1,54 @@
+#pragma once
+#include "ASGraph.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+enum class HijackType {
+    PREFIX,     // the attacker announces the victim's prefix
+    SUBPREFIX,  // the attacker announces a more specific prefix inside it
+    LEAK        // the attacker re-exports the victim's route it learned from
+                // a provider or peer to all of its neighbors
+};
+
+// Where an AS's traffic for the victim's addresses ends up
+struct OutcomeCounts {
+    uint64_t attacker = 0;
+    uint64_t victim = 0;
+    uint64_t neither = 0;  // no route to either origin
+
+    uint64_t total() const { return attacker + victim + neither; }
+    double fraction(uint64_t count) const { return total() ? static_cast<double>(count) / total() : 0.0; }
+};
+
+// One victim/attacker pair propagated over a frozen topology. Instead of
+// writing RIBs, the outcome of every AS other than the two origins is read
+// straight from its RIB and counted by ROV adoption. The victim's prefix is
+// covered by a ROA, so a hijacker's announcement is always ROV-invalid and
+// the hijacker itself never runs ROV. A leaked route is valid: an AS counts
+// for the attacker when its route crosses the leaker.
+class HijackScenario {
+public:
+    int victimASN = 0;
+    int attackerASN = 0;
+    HijackType type = HijackType::SUBPREFIX;
+    std::string prefix = "1.2.0.0/16";     // announced by the victim
+    std::string subprefix = "1.2.3.0/24";  // announced by a subprefix attacker
+
+    OutcomeCounts rov;  // ASes that drop ROV-invalid routes
+    OutcomeCounts bgp;  // ASes that do not
+    OutcomeCounts all() const {
+        return {rov.attacker + bgp.attacker, rov.victim + bgp.victim, rov.neither + bgp.neither};
+    }
+
+    // Resets graph's routing state, seeds both origins, propagates and counts
+    bool run(ASGraph& graph, const std::set<int>& rovASNs);
+    void printSummary() const;
+    bool writeCSV(const std::string& filename) const;
+
+private:
+    bool leakedPath(ASGraph& graph, const std::set<int>& rovASNs, std::vector<int>& path) const;
+    void seedLeak(ASGraph& graph, const std::set<int>& rovASNs, const std::vector<int>& path) const;
+    void countOutcomes(const ASGraph& graph);
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using PathRef = uint32_t;
+
+class PathStore;
+
+// One writer's slice of a PathStore. Only the owning thread may prepend to a
+// shard; any thread may read nodes published before the last pool barrier.
+class PathShard {
+public:
+    PathRef prepend(int asn, PathRef parent);
+
+private:
+    friend class PathStore;
+
+    struct Node {
+        int asn;
+        PathRef parent;
+        uint32_t length;
+    };
+
+    static constexpr uint32_t CHUNK_BITS = 16;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    // Open-addressed (asn, parent) -> node table. Slots are one flat array
+    // grown by doubling, so prepending allocates nothing per node. A ref of 0
+    // marks an empty slot: node 0 of shard 0 (the empty path) is never indexed.
+    struct Slot {
+        uint64_t key;
+        PathRef ref;
+    };
+
+    PathShard(const PathStore& store, PathRef base, uint64_t capacity);
+
+    void growIndex();
+
+    const PathStore& store;
+    PathRef base;
+    uint32_t count;
+    bool full;  // a prepend found no room; set by the owning thread only
+    // Sized once so readers never race a reallocation; chunks appear lazily
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    std::vector<Slot> index;
+    uint64_t indexMask;
+    uint32_t indexed;
+};
+
+// Immutable AS paths stored as a parent-pointer tree.
+// A path is its first ASN plus a reference to the rest of the path, so
+// prepending is O(1) and every path shares its suffix with the sender's.
+// Nodes are hash-consed on (asn, parent) within a shard: identical paths
+// share one node. The top bits of a PathRef select the shard.
+class PathStore {
+public:
+    static constexpr PathRef EMPTY = 0;
+    // Shard bits come out of the 32-bit PathRef, so more shards means fewer
+    // nodes per shard; this keeps every shard at 2^24 nodes or more
+    static constexpr unsigned MAX_SHARDS = 256;
+
+    explicit PathStore(unsigned shardCount = 1);
+
+    PathShard& shard(unsigned i) { return *shards[i]; }
+    unsigned shardCount() const { return static_cast<unsigned>(shards.size()); }
+
+    PathRef prepend(int asn, PathRef parent) { return shards[0]->prepend(asn, parent); }
+
+    int head(PathRef path) const { return node(path).asn; }
+    PathRef parent(PathRef path) const { return node(path).parent; }
+    uint32_t length(PathRef path) const { return node(path).length; }
+    int origin(PathRef path) const {  // last ASN of a non-empty path
+        while (parent(path) != EMPTY) path = parent(path);
+        return head(path);
+    }
+    std::vector<int> toVector(PathRef path) const;
+
+    size_t size() const;
+    // True once a shard ran out of nodes; its later prepends returned the
+    // parent unchanged, so every path built since is wrong
+    bool full() const;
+
+    // Dense numbering of every node, shard by shard, for serialization.
+    // denseOffsets()[s] is the dense index of shard s's first node.
+    std::vector<uint32_t> denseOffsets() const;
+    uint32_t denseIndex(PathRef path, const std::vector<uint32_t>& offsets) const {
+        return offsets[static_cast<uint64_t>(path) >> shardShift] + static_cast<uint32_t>(path & indexMask);
+    }
+    uint32_t shardSize(unsigned i) const { return shards[i]->count; }
+    PathRef nodeRef(unsigned shard, uint32_t i) const { return shards[shard]->base | i; }
+
+    void clear() { reset(shardCount()); }
+    void reset(unsigned shardCount);  // shardCount <= MAX_SHARDS
+
+private:
+    std::vector<std::unique_ptr<PathShard>> shards;
+    unsigned shardShift;
+    uint64_t indexMask;
+
+    const PathShard::Node& node(PathRef path) const {
+        const PathShard& owner = *shards[static_cast<uint64_t>(path) >> shardShift];
+        uint32_t i = static_cast<uint32_t>(path & indexMask);
+        return owner.chunks[i >> PathShard::CHUNK_BITS][i & (PathShard::CHUNK_SIZE - 1)];
+    }
+};
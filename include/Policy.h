@@ -1,34 +1,57 @@
 #pragma once
 #include "Announcement.h"
-#include <unordered_map>
+#include "RIB.h"
+#include <cstdint>
 #include <vector>
 
+// How the propagation engine dispatches a node's policy. BGP and ROV run
+// compile-time kernels; CUSTOM (any other BGP subclass) goes through the
+// virtual interface; NONE nodes take no part in propagation.
+enum class PolicyKind : uint8_t {
+    NONE,
+    BGP,
+    ROV,
+    CUSTOM
+};
+
 class Policy {
 public:
     virtual ~Policy() = default;
-    virtual void processAnnouncements(int currentASN) = 0;
-    virtual void addToReceivedQueue(const std::string& prefix, const Announcement& announcement) = 0;
+    virtual void processAnnouncements(int currentASN, PathShard& paths) = 0;
+    virtual void addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) = 0;
     virtual std::vector<Announcement> getAnnouncementsToSend() = 0;
 };
 
 class BGP : public Policy {
 public:
-    std::unordered_map<std::string, Announcement> localRIB;
-    std::unordered_map<std::string, std::vector<Announcement>> receivedQueue;
+    RIB localRIB;
+    std::vector<Announcement> receivedQueue;
 
-    void processAnnouncements(int currentASN) override;
-    void addToReceivedQueue(const std::string& prefix, const Announcement& announcement) override;
+    void processAnnouncements(int currentASN, PathShard& paths) override;
+    // processAnnouncements for the built-in policies, reporting what happened
+    RouteCounts processReceivedQueue(int currentASN, PathShard& paths);
+    void addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) override;
     std::vector<Announcement> getAnnouncementsToSend() override;
-    void seedAnnouncement(const std::string& prefix, int originASN);
-    virtual void seedAnnouncement(const std::string& prefix, int originASN, bool rovInvalid);
+    void seedAnnouncement(PrefixId prefixId, int originASN, PathStore& paths);
+    virtual void seedAnnouncement(PrefixId prefixId, int originASN, bool rovInvalid, PathStore& paths);
+
+    // Pull-based receive: read a finalized neighbor's RIB directly and keep
+    // the better route per prefix, without queues or intermediate copies
+    void receiveFrom(const BGP& neighbor, int neighborASN, Relationship relationship,
+                     int currentASN, PathShard& paths);
+    RouteCounts receiveInto(RIB& target, const RIB& neighborRIB, int neighborASN, Relationship relationship,
+                            int currentASN, PathShard& paths) const;
+
+    // Whether invalid announcements are dropped on receipt (ROV)
+    virtual bool dropsInvalid() const { return false; }
 
 protected:
-    Announcement selectBestAnnouncement(const std::vector<Announcement>& announcements);
-    bool isBetterThan(const Announcement& candidate, const Announcement& existing);
+    bool isBetterThan(const Announcement& candidate, const Announcement& existing) const;
 };
 
 class ROV : public BGP {
 public:
-    void addToReceivedQueue(const std::string& prefix, const Announcement& announcement) override;
-    void seedAnnouncement(const std::string& prefix, int originASN, bool rovInvalid) override;
+    void addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) override;
+    void seedAnnouncement(PrefixId prefixId, int originASN, bool rovInvalid, PathStore& paths) override;
+    bool dropsInvalid() const override { return true; }
 };
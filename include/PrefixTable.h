@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using PrefixId = uint32_t;
+
+// Interns prefix strings so announcements and RIBs can key on a 32-bit ID.
+// The string form is only needed again when results are written out.
+class PrefixTable {
+public:
+    // The keys view the stored strings, which a copy would not carry over
+    PrefixTable() = default;
+    PrefixTable(const PrefixTable&) = delete;
+    PrefixTable& operator=(const PrefixTable&) = delete;
+    PrefixTable(PrefixTable&&) = default;
+    PrefixTable& operator=(PrefixTable&&) = default;
+
+    PrefixId intern(std::string_view prefix);
+    bool find(std::string_view prefix, PrefixId& id) const;  // false if never interned
+    const std::string& toString(PrefixId id) const { return prefixes[id]; }
+    size_t size() const { return prefixes.size(); }
+    void reserve(size_t count) { ids.reserve(count); }
+    void clear();
+
+private:
+    // A deque never moves its strings, so the keys can view them and
+    // lookups straight from a parse buffer allocate nothing
+    std::deque<std::string> prefixes;
+    std::unordered_map<std::string_view, PrefixId> ids;
+};
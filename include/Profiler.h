@@ -0,0 +1,68 @@
+#pragma once
+#include "RIB.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Opt-in phase timers and route counters (--stats / --profile-json).
+// Nothing is recorded unless a Profiler is attached to the graph; the
+// kernels always return their counts by value, and engines only fold them
+// into the per-worker slots when profiling is on.
+class Profiler {
+public:
+    struct Phase {
+        std::string name;
+        int depth;            // nesting level; engine phases sit under "propagate"
+        double milliseconds;
+        RouteCounts counts;
+        size_t edges = 0;     // peer edges that carried routes (across only)
+    };
+
+    std::vector<Phase> phases;  // in the order they started
+
+    void begin(const std::string& name);
+    void end();  // closes the innermost open phase
+
+    // Per-worker counters for the innermost open phase, folded in by end()
+    void setWorkers(unsigned workers);
+    RouteCounts& counts(unsigned worker) { return workerCounts[worker].counts; }
+
+    // Adds to the innermost open phase; called outside worker tasks
+    void addEdges(size_t edges) {
+        if (!open.empty()) phases[open.back()].edges += edges;
+    }
+
+    RouteCounts totals() const;
+    static size_t peakRSSKilobytes();
+
+    void printSummary() const;
+    bool writeJSON(const std::string& filename, const std::string& engine, unsigned threads) const;
+
+private:
+    // Padded so workers never share a cache line
+    struct alignas(64) WorkerCounts {
+        RouteCounts counts;
+    };
+
+    std::vector<WorkerCounts> workerCounts = std::vector<WorkerCounts>(1);
+    std::vector<size_t> open;
+    std::vector<std::chrono::steady_clock::time_point> started;
+};
+
+// Times one phase for its lifetime; a no-op without a profiler
+class ScopedPhase {
+public:
+    ScopedPhase(Profiler* profiler, const std::string& name) : profiler(profiler) {
+        if (profiler) profiler->begin(name);
+    }
+    ~ScopedPhase() {
+        if (profiler) profiler->end();
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    Profiler* profiler;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "Announcement.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// What happened to routes offered to a table. Kernels return these by
+// value; the Profiler collects them per phase.
+struct RouteCounts {
+    uint64_t sent = 0;          // offered to a receiver (after loop prevention)
+    uint64_t droppedByROV = 0;  // invalid routes refused by an ROV receiver
+    uint64_t accepted = 0;      // first route for its prefix
+    uint64_t replaced = 0;      // beat the route already held
+    uint64_t rejected = 0;      // lost to the route already held
+
+    RouteCounts& operator+=(const RouteCounts& other) {
+        sent += other.sent;
+        droppedByROV += other.droppedByROV;
+        accepted += other.accepted;
+        replaced += other.replaced;
+        rejected += other.rejected;
+        return *this;
+    }
+};
+
+// Per-AS routing table: one announcement per prefix, kept sorted by prefix ID.
+// ASes typically hold tens of prefixes, so a flat vector beats a hash map.
+class RIB {
+public:
+    using iterator = std::vector<Announcement>::iterator;
+    using const_iterator = std::vector<Announcement>::const_iterator;
+
+    Announcement* find(PrefixId prefixId) {
+        auto it = lowerBound(prefixId);
+        return (it != entries.end() && it->prefixId == prefixId) ? &*it : nullptr;
+    }
+
+    const Announcement* find(PrefixId prefixId) const {
+        return const_cast<RIB*>(this)->find(prefixId);
+    }
+
+    void insertOrAssign(const Announcement& announcement) {
+        auto it = lowerBound(announcement.prefixId);
+        if (it != entries.end() && it->prefixId == announcement.prefixId) {
+            *it = announcement;
+        } else {
+            entries.insert(it, announcement);
+        }
+    }
+
+    // Append routes for prefixes not yet in the RIB; additions must be
+    // sorted by prefix ID
+    void insertSorted(const std::vector<Announcement>& additions) {
+        if (additions.empty()) return;
+        // Merge backward into the grown vector: only entries that sort after
+        // an addition move, and no scratch buffer is needed
+        auto left = entries.size();
+        entries.resize(left + additions.size());
+        auto right = additions.size();
+        auto write = entries.size();
+        while (right > 0) {
+            if (left > 0 && entries[left - 1].prefixId > additions[right - 1].prefixId) {
+                entries[--write] = entries[--left];
+            } else {
+                entries[--write] = additions[--right];
+            }
+        }
+    }
+
+    // Fold fully built candidates (one per prefix) into the RIB, keeping
+    // whichever route the decision process prefers
+    RouteCounts mergeBest(const RIB& candidates) {
+        static thread_local std::vector<Announcement> additions;
+        additions.clear();
+        RouteCounts counts;
+        auto cursor = entries.begin();
+        for (const auto& candidate : candidates) {
+            while (cursor != entries.end() && cursor->prefixId < candidate.prefixId) ++cursor;
+            if (cursor != entries.end() && cursor->prefixId == candidate.prefixId) {
+                if (candidate.isBetterThan(*cursor)) {
+                    *cursor = candidate;
+                    counts.replaced++;
+                } else {
+                    counts.rejected++;
+                }
+            } else {
+                additions.push_back(candidate);
+            }
+        }
+        counts.accepted = additions.size();
+        insertSorted(additions);
+        return counts;
+    }
+
+    void insertSorted(const RIB& additions) { insertSorted(additions.entries); }
+
+    void erase(PrefixId prefixId) {
+        auto it = lowerBound(prefixId);
+        if (it != entries.end() && it->prefixId == prefixId) entries.erase(it);
+    }
+
+    // Drop every route the predicate selects
+    template <typename Predicate>
+    void removeIf(Predicate predicate) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), predicate), entries.end());
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    // Unlike clear(), also gives the storage back
+    void release() { std::vector<Announcement>().swap(entries); }
+    size_t memoryBytes() const { return entries.capacity() * sizeof(Announcement); }
+
+private:
+    std::vector<Announcement> entries;
+
+    std::vector<Announcement>::iterator lowerBound(PrefixId prefixId) {
+        return std::lower_bound(entries.begin(), entries.end(), prefixId,
+                                [](const Announcement& entry, PrefixId id) {
+                                    return entry.prefixId < id;
+                                });
+    }
+};
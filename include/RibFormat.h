@@ -0,0 +1,62 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Shared by the simulator and the ribs_to_csv converter so both produce
+// byte-identical ribs.csv text.
+
+const char RIB_CSV_HEADER[] = "asn,prefix,as_path\n";
+
+// Longest text an int can format to, plus the ", " separator
+const size_t RIB_MAX_FIELD = 13;
+
+inline size_t maxRibRowSize(size_t prefixLength, uint32_t pathLength) {
+    return prefixLength + RIB_MAX_FIELD * (pathLength + 1) + 8;
+}
+
+// Format one `asn,prefix,"(hop, hop, ...)"` row; cursor must have room for
+// maxRibRowSize() bytes. Single-hop paths keep Python's tuple comma: "(1,)".
+inline char* formatRibRow(char* cursor, int asn, const char* prefix, size_t prefixLength,
+                          const int* hops, uint32_t pathLength) {
+    cursor = std::to_chars(cursor, cursor + RIB_MAX_FIELD, asn).ptr;
+    *cursor++ = ',';
+    std::memcpy(cursor, prefix, prefixLength);
+    cursor += prefixLength;
+    std::memcpy(cursor, ",\"(", 3);
+    cursor += 3;
+    for (uint32_t hop = 0; hop < pathLength; hop++) {
+        if (hop > 0) {
+            *cursor++ = ',';
+            *cursor++ = ' ';
+        }
+        cursor = std::to_chars(cursor, cursor + RIB_MAX_FIELD, hops[hop]).ptr;
+    }
+    if (pathLength == 1) *cursor++ = ',';
+    std::memcpy(cursor, ")\"\n", 3);
+    return cursor + 3;
+}
+
+// Binary RIB dump (--output-format bin). Columnar, native byte order:
+//   RibFileHeader
+//   int32  asn[rowCount]
+//   uint32 prefixId[rowCount]
+//   uint32 pathId[rowCount]
+//   int32  pathHead[pathCount]      first ASN of each deduplicated path
+//   uint32 pathParent[pathCount]    rest of the path; path 0 is the empty path
+//   uint32 stringOffsets[prefixCount + 1]
+//   char   strings[stringBytes]     prefix text, indexed by prefix ID
+// Rows appear in the same order as in ribs.csv.
+
+const char RIB_FILE_MAGIC[8] = {'B', 'G', 'P', 'R', 'I', 'B', 'S', '\0'};
+const uint32_t RIB_FILE_VERSION = 1;
+
+struct RibFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t prefixCount;
+    uint64_t rowCount;
+    uint64_t pathCount;
+    uint64_t stringBytes;
+};
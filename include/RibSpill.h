@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Finished RIB rows moved out of memory during a budgeted run
+// (ASGraph::setMemoryBudget). Each node's rows are appended once, already
+// formatted as ribs.csv text, and read back by node when the output file is
+// written. The file is removed when the spill is destroyed.
+class RibSpill {
+public:
+    RibSpill() = default;
+    ~RibSpill();
+
+    RibSpill(const RibSpill&) = delete;
+    RibSpill& operator=(const RibSpill&) = delete;
+
+    bool open(const std::string& filename, size_t nodeCount);
+    bool append(uint32_t index, const char* data, size_t size, uint32_t rowCount);
+    // Flushes the rows appended since the last commit and, only if they
+    // reached the file, marks their nodes as spilled. After a failure the
+    // spill takes no more rows.
+    bool commit(const std::vector<uint32_t>& indices);
+    // Switches from writing to reading; call before read()
+    bool finishWriting();
+
+    bool holds(uint32_t index) const { return index < extents.size() && extents[index].spilled; }
+    uint32_t rowCount(uint32_t index) const { return extents[index].rowCount; }
+    uint64_t totalRows() const { return rows; }
+    uint64_t totalBytes() const { return bytes; }
+    const std::string& path() const { return filename; }
+
+    // Appends the node's rows to out; safe to call from several threads
+    bool read(uint32_t index, std::string& out) const;
+
+private:
+    struct Extent {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t rowCount = 0;
+        bool spilled = false;
+    };
+
+    std::vector<Extent> extents;  // per node index
+    std::string filename;
+    std::ofstream writer;
+    int fd = -1;
+    bool failed = false;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+};
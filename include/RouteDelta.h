@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One origin route added to or withdrawn from the seed set
+struct SeedChange {
+    int asn;
+    std::string prefix;
+    bool rovInvalid;  // ignored for withdrawals
+};
+
+// A what-if change to an already converged simulation
+class RouteDelta {
+public:
+    std::vector<SeedChange> announced;
+    std::vector<SeedChange> withdrawn;
+    std::vector<int> enableROV;   // BGP ASes switching to ROV
+    std::vector<int> disableROV;  // ROV ASes switching back to plain BGP
+
+    // CSV with header action,asn,prefix,rov_invalid; action is one of
+    // announce, withdraw, rov_on or rov_off (the last two need only the ASN)
+    bool loadFromCSV(const std::string& filename);
+    bool empty() const {
+        return announced.empty() && withdrawn.empty() && enableROV.empty() && disableROV.empty();
+    }
+};
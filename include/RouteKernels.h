@@ -0,0 +1,167 @@
+#pragma once
+#include "PathStore.h"
+#include "RIB.h"
+#include <algorithm>
+#include <vector>
+
+// Per-announcement work for the built-in policies, specialized at compile
+// time on whether invalid routes are dropped. The engine picks the kernel
+// once per group of same-policy receivers, so no virtual call or RTTI check
+// happens per announcement.
+
+// Queue a sender's routes for a receiver (push engine)
+template <bool DropInvalid>
+RouteCounts enqueueRoutes(std::vector<Announcement>& queue, const RIB& source, int senderASN,
+                          int receiverASN, Relationship relationship) {
+    RouteCounts counts;
+    for (const auto& announcement : source) {
+        // Don't send back to the AS we received it from
+        if (announcement.nextHopASN == receiverASN) continue;
+        counts.sent++;
+        if (DropInvalid && announcement.rovInvalid) {
+            counts.droppedByROV++;
+            continue;
+        }
+
+        queue.push_back(announcement.createPropagated(senderASN, relationship));
+    }
+    return counts;
+}
+
+// Fold a finalized neighbor's routes straight into target (pull engine).
+// Without prependOwner the stored paths stay the sender's; pathLength still
+// counts the receiver, whose ASN is added when the rows are written.
+template <bool DropInvalid>
+RouteCounts receiveRoutes(RIB& target, const RIB& source, int neighborASN, Relationship relationship,
+                          int currentASN, PathShard& paths, bool prependOwner = true) {
+    // Reused by every call on this thread, so steady-state merges allocate
+    // nothing beyond the target RIB's own growth
+    static thread_local std::vector<Announcement> additions;
+    additions.clear();
+    RouteCounts counts;
+
+    // Both RIBs are sorted by prefix ID, so walk them together
+    auto cursor = target.begin();
+    for (const auto& announcement : source) {
+        // Don't take back routes the neighbor learned from us
+        if (announcement.nextHopASN == currentASN) continue;
+        counts.sent++;
+        if (DropInvalid && announcement.rovInvalid) {
+            counts.droppedByROV++;
+            continue;
+        }
+
+        Announcement candidate = announcement.createPropagated(neighborASN, relationship);
+        candidate.pathLength++;
+
+        while (cursor != target.end() && cursor->prefixId < candidate.prefixId) ++cursor;
+        if (cursor != target.end() && cursor->prefixId == candidate.prefixId) {
+            if (candidate.isBetterThan(*cursor)) {
+                if (prependOwner) candidate.asPath = paths.prepend(currentASN, announcement.asPath);
+                *cursor = candidate;
+                counts.replaced++;
+            } else {
+                counts.rejected++;
+            }
+        } else {
+            if (prependOwner) candidate.asPath = paths.prepend(currentASN, announcement.asPath);
+            additions.push_back(candidate);
+        }
+    }
+
+    counts.accepted += additions.size();
+    target.insertSorted(additions);
+    return counts;
+}
+
+// Best-route table for receivers with many senders (pull engine). Every
+// sender's routes are offered first; per prefix, the packed decision key
+// and the winning route sit in parallel arrays, so each offer is a single
+// integer compare. Path nodes are created only for the final winners, not
+// for every route that leads for a while. One table per thread, reused.
+struct CandidateTable {
+    static constexpr uint64_t NO_CANDIDATE = ~0ull;
+
+    std::vector<uint64_t> keys;                // per prefix ID
+    std::vector<const Announcement*> routes;   // per prefix ID, the sender's entry
+    std::vector<PrefixId> touched;             // prefixes with a candidate
+    uint64_t offers = 0;
+
+    static CandidateTable& local() {
+        static thread_local CandidateTable table;
+        return table;
+    }
+
+    void offer(PrefixId prefixId, uint64_t key, const Announcement& route) {
+        if (prefixId >= keys.size()) {
+            keys.resize(prefixId + 1, NO_CANDIDATE);
+            routes.resize(prefixId + 1, nullptr);
+        }
+        offers++;
+        if (keys[prefixId] == NO_CANDIDATE) {
+            touched.push_back(prefixId);
+        } else if (key >= keys[prefixId]) {
+            return;
+        }
+        keys[prefixId] = key;
+        routes[prefixId] = &route;
+    }
+};
+
+template <bool DropInvalid>
+RouteCounts offerRoutes(CandidateTable& table, const RIB& source, int neighborASN, Relationship relationship,
+                        int currentASN) {
+    RouteCounts counts;
+    for (const auto& announcement : source) {
+        // Don't take back routes the neighbor learned from us
+        if (announcement.nextHopASN == currentASN) continue;
+        counts.sent++;
+        if (DropInvalid && announcement.rovInvalid) {
+            counts.droppedByROV++;
+            continue;
+        }
+        table.offer(announcement.prefixId,
+                    Announcement::decisionKey(relationship, announcement.pathLength + 1, neighborASN),
+                    announcement);
+    }
+    return counts;
+}
+
+// Fold each offered prefix's winner into target and clear the table. Only
+// the winners are counted as accepted or replaced; every other offer lost.
+// prependOwner works as in receiveRoutes.
+inline RouteCounts commitCandidates(CandidateTable& table, RIB& target, int currentASN, PathShard& paths,
+                                    bool prependOwner = true) {
+    static thread_local std::vector<Announcement> additions;
+    additions.clear();
+    RouteCounts counts;
+
+    std::sort(table.touched.begin(), table.touched.end());
+    auto cursor = target.begin();
+    for (PrefixId prefixId : table.touched) {
+        uint64_t key = table.keys[prefixId];
+        const Announcement& route = *table.routes[prefixId];
+        table.keys[prefixId] = CandidateTable::NO_CANDIDATE;
+
+        while (cursor != target.end() && cursor->prefixId < prefixId) ++cursor;
+        bool held = cursor != target.end() && cursor->prefixId == prefixId;
+        if (held && cursor->decisionKey() <= key) continue;
+
+        PathRef path = prependOwner ? paths.prepend(currentASN, route.asPath) : route.asPath;
+        Announcement winner(prefixId, path, Announcement::keyPathLength(key),
+                            Announcement::keyNextHopASN(key), Announcement::keyRelationship(key), route.rovInvalid);
+        if (held) {
+            *cursor = winner;
+            counts.replaced++;
+        } else {
+            additions.push_back(winner);
+        }
+    }
+
+    counts.accepted = additions.size();
+    counts.rejected = table.offers - counts.accepted - counts.replaced;
+    table.touched.clear();
+    table.offers = 0;
+    target.insertSorted(additions);
+    return counts;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "ASGraph.h"
+#include <string>
+#include <vector>
+
+// One announcements/ROV deployment pair and where its RIBs go
+struct Scenario {
+    std::string announcementsFile;
+    std::string rovASNsFile;
+    std::string outputFile;
+};
+
+// Runs many scenarios against one frozen topology. The topology is parsed,
+// checked and flattened once; each runner copies it into its own ASGraph
+// and only resets policy and RIB state between scenarios.
+class ScenarioBatch {
+public:
+    std::vector<Scenario> scenarios;
+    unsigned concurrentScenarios = 1;  // scenarios in flight at once
+    unsigned threadsPerScenario = 1;   // propagation workers per scenario
+    unsigned prefixShards = 1;         // prefix shards per scenario
+    PropagationEngine engine = PropagationEngine::PUSH;
+    bool binaryOutput = false;
+    bool implicitStubs = false;
+
+    // CSV manifest with header announcements,rov_asns,output
+    bool loadManifest(const std::string& filename);
+    bool run(const ASGraph& topologySource);
+
+private:
+    bool runScenario(ASGraph& graph, const Scenario& scenario, size_t& routes) const;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Generates a CAIDA-style Internet for benchmarking at sizes beyond today's
+// (benchmark.cpp). ASes join one at a time and buy transit from earlier
+// ASes, preferring well-connected ones, so the provider graph is acyclic and
+// heavy-tailed with a fully peered tier-1 clique on top. ASNs are shuffled
+// so that dense indices do not follow the hierarchy. The same settings
+// always produce the same files.
+class SyntheticTopology {
+public:
+    uint32_t asCount = 100000;
+    uint32_t tier1Count = 16;      // fully peered, no providers
+    double transitFraction = 0.15; // ASes that can be chosen as providers
+    double peersPerAS = 2.0;       // average peer links per AS
+    uint32_t prefixCount = 50;     // one origin each; every AS ends up with a route to each
+    double hijackFraction = 0.1;   // prefixes also announced by an ROV-invalid origin
+    double rovFraction = 0.1;      // ASes that run ROV
+    uint64_t seed = 1;
+
+    // Writes relationships.txt, anns.csv and rov_asns.csv into directory,
+    // which must exist. The files use the simulator's input formats.
+    bool write(const std::string& directory) const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers that run one task together and then wait.
+// The calling thread takes part as worker 0, so a pool of size 1 runs
+// everything inline with no synchronization at all.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Runs task(worker) once on every worker and returns when all are done
+    void run(const std::function<void(unsigned)>& task);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startCv;
+    std::condition_variable doneCv;
+    const std::function<void(unsigned)>* currentTask = nullptr;
+    unsigned long generation = 0;
+    unsigned pending = 0;
+    bool stopping = false;
+
+    void workerLoop(unsigned worker);
+};
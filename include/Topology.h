@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One raw line of a CAIDA relationship file
+struct RelationshipEdge {
+    int as1;
+    int as2;
+    int relationship;
+};
+
+// View over one node's slice of a CSR neighbor array
+struct NeighborRange {
+    const uint32_t* first;
+    const uint32_t* last;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Frozen AS topology in compressed-sparse-row form.
+// Nodes are addressed by dense indices assigned in ascending ASN order,
+// so comparing indices orders nodes the same way as comparing ASNs.
+class Topology {
+public:
+    std::vector<int> asns;  // index -> ASN, sorted ascending
+
+    std::vector<uint32_t> providerOffsets;  // size() + 1 entries
+    std::vector<uint32_t> providerList;
+    std::vector<uint32_t> customerOffsets;
+    std::vector<uint32_t> customerList;
+    std::vector<uint32_t> peerOffsets;
+    std::vector<uint32_t> peerList;
+
+    void build(const std::vector<RelationshipEdge>& edges);
+
+    size_t size() const { return asns.size(); }
+    int indexOf(int asn) const;  // -1 if the ASN is not in the graph
+
+    NeighborRange providers(uint32_t index) const {
+        return range(providerOffsets, providerList, index);
+    }
+    NeighborRange customers(uint32_t index) const {
+        return range(customerOffsets, customerList, index);
+    }
+    NeighborRange peers(uint32_t index) const {
+        return range(peerOffsets, peerList, index);
+    }
+
+private:
+    static NeighborRange range(const std::vector<uint32_t>& offsets,
+                               const std::vector<uint32_t>& list, uint32_t index) {
+        return {list.data() + offsets[index], list.data() + offsets[index + 1]};
+    }
+};
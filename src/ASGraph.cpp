@@ -1,143 +1,224 @@
 #include "ASGraph.h"
+#include "MappedFile.h"
 #include "Policy.h"
+#include "RouteKernels.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
-#include <functional>
-#include <queue>
 #include <algorithm>
-
-ASNodePtr ASGraph::getOrCreateNode(int asn) {
-    if (nodes.find(asn) == nodes.end()) {
-        nodes[asn] = std::make_shared<ASNode>(asn);
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <typeinfo>
+
+ASNode* ASGraph::findNode(int asn) {
+    int index = topology.indexOf(asn);
+    if (index < 0) {
+        return nullptr;
     }
-    return nodes[asn];
+    return &nodes[index];
 }
 
 void ASGraph::addRelationship(int as1, int as2, int relationship) {
-    ASNodePtr node1 = getOrCreateNode(as1);
-    ASNodePtr node2 = getOrCreateNode(as2);
-
-    if (relationship == -1) {
-        // CAIDA standard: Provider-to-Customer (AS1 → AS2)
-        // as1 is provider of as2
-        node1->customers.insert(as2);
-        node2->providers.insert(as1);
-    } else if (relationship == 0) {
-        // CAIDA standard: Peer-to-Peer
-        node1->peers.insert(as2);
-        node2->peers.insert(as1);
-    } else if (relationship == 1) {
-        // CAIDA standard: Sibling (usually ignored)
-        // For now, treat as peer relationship
-        node1->peers.insert(as2);
-        node2->peers.insert(as1);
+    // Edges are buffered until buildTopology() freezes them into CSR arrays
+    pendingEdges.push_back({as1, as2, relationship});
+}
+
+void ASGraph::buildTopology() {
+    topology.build(pendingEdges);
+    pendingEdges.clear();
+    pendingEdges.shrink_to_fit();
+
+    nodes.clear();
+    nodes.reserve(topology.size());
+    for (int asn : topology.asns) {
+        nodes.emplace_back(asn);
     }
+    propagationRanks.clear();
 }
 
+void ASGraph::copyTopology(const ASGraph& source) {
+    topology = source.topology;
+    propagationRanks = source.propagationRanks;
+
+    nodes.clear();
+    nodes.reserve(topology.size());
+    for (const auto& node : source.nodes) {
+        nodes.emplace_back(node.asn);
+        nodes.back().propagationRank = node.propagationRank;
+    }
+    resetRoutingState();
+}
+
+void ASGraph::resetRoutingState() {
+    for (auto& node : nodes) {
+        node.policy.reset();
+    }
+    policyKinds.clear();
+    bgpPolicies.clear();
+    rankGroups.clear();
+    allGroups = PolicyGroups();
+    implicitRIB.clear();
+    seeds.clear();
+    prefixes.clear();
+    spill.reset();
+    spillWindows.clear();
+    ownerHopDeferred.clear();
+    spillPending.clear();
+    spillFailed = false;
+    resetPaths();
+}
+
+namespace {
+
+// Parse one decimal field and require it to be followed by a '|'
+const char* parseField(const char* p, const char* end, int& value) {
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() || result.ptr == end || *result.ptr != '|') {
+        return nullptr;
+    }
+    return result.ptr + 1;
+}
+
+// Parse "as1|as2|rel|source" lines in [begin, end), which must start at a line boundary
+void parseRelationships(const char* begin, const char* end, std::vector<RelationshipEdge>& edges) {
+    const char* line = begin;
+    while (line < end) {
+        // memchr is vectorized in libc, so this is the hot newline scan
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol) eol = end;
+
+        if (line != eol && *line != '#') {
+            RelationshipEdge edge;
+            const char* p = parseField(line, eol, edge.as1);
+            if (p) p = parseField(p, eol, edge.as2);
+            if (p) p = parseField(p, eol, edge.relationship);
+            if (p) edges.push_back(edge);
+        }
+        line = eol + 1;
+    }
+}
+
+} // namespace
+
 bool ASGraph::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filename)) {
         std::cerr << "Error opening file: " << filename << std::endl;
         return false;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
-
-        std::istringstream iss(line);
-        std::string as1_str, as2_str, rel_str, source;
-
-        if (std::getline(iss, as1_str, '|') &&
-            std::getline(iss, as2_str, '|') &&
-            std::getline(iss, rel_str, '|') &&
-            std::getline(iss, source)) {
+    // Split the file into one line-aligned chunk per worker
+    unsigned chunkCount = threadCount();
+    std::vector<const char*> bounds(chunkCount + 1, file.end());
+    bounds[0] = file.begin();
+    for (unsigned i = 1; i < chunkCount; i++) {
+        const char* cut = std::max(bounds[i - 1], file.begin() + file.size() * i / chunkCount);
+        const char* eol = static_cast<const char*>(std::memchr(cut, '\n', file.end() - cut));
+        bounds[i] = eol ? eol + 1 : file.end();
+    }
 
-            int as1 = std::stoi(as1_str);
-            int as2 = std::stoi(as2_str);
-            int relationship = std::stoi(rel_str);
+    std::vector<std::vector<RelationshipEdge>> chunkEdges(chunkCount);
+    runWorkers([&](unsigned worker) {
+        // CAIDA lines average a little over 20 bytes
+        chunkEdges[worker].reserve((bounds[worker + 1] - bounds[worker]) / 20);
+        parseRelationships(bounds[worker], bounds[worker + 1], chunkEdges[worker]);
+    });
 
-            addRelationship(as1, as2, relationship);
-        }
+    for (const auto& edges : chunkEdges) {
+        pendingEdges.insert(pendingEdges.end(), edges.begin(), edges.end());
     }
 
     file.close();
+    buildTopology();
     return true;
 }
 
-bool ASGraph::hasCycleDFS(int start, std::set<int>& visited, std::set<int>& recStack,
-                          const std::function<const std::set<int>&(const ASNodePtr&)>& getNeighbors) {
-    visited.insert(start);
-    recStack.insert(start);
+// Kahn's algorithm over customer in-degree: an AS is placed once every one of
+// its customers has been, one rank above the highest of them. Iterative and
+// O(V+E). Returns the number of placed nodes; anything left unplaced sits on
+// a provider cycle or above one.
+uint32_t ASGraph::layerByCustomers(std::vector<uint32_t>& order, std::vector<uint32_t>& rank) const {
+    uint32_t nodeCount = static_cast<uint32_t>(topology.size());
+    std::vector<uint32_t> pending(nodeCount);
+    order.clear();
+    order.reserve(nodeCount);
+    rank.assign(nodeCount, 0);
+
+    for (uint32_t index = 0; index < nodeCount; index++) {
+        pending[index] = static_cast<uint32_t>(topology.customers(index).size());
+        if (pending[index] == 0) {
+            order.push_back(index);
+        }
+    }
 
-    if (nodes.find(start) != nodes.end()) {
-        const std::set<int>& neighbors = getNeighbors(nodes[start]);
-        for (int neighbor : neighbors) {
-            if (recStack.find(neighbor) != recStack.end()) {
-                return true;
-            }
-            if (visited.find(neighbor) == visited.end()) {
-                if (hasCycleDFS(neighbor, visited, recStack, getNeighbors)) {
-                    return true;
-                }
+    // order doubles as the work queue
+    for (size_t head = 0; head < order.size(); head++) {
+        uint32_t current = order[head];
+        for (uint32_t provider : topology.providers(current)) {
+            rank[provider] = std::max(rank[provider], rank[current] + 1);
+            if (--pending[provider] == 0) {
+                order.push_back(provider);
             }
         }
     }
-
-    recStack.erase(start);
-    return false;
+    return static_cast<uint32_t>(order.size());
 }
 
-bool ASGraph::hasProviderCycle() {
-    std::set<int> visited;
-    std::set<int> recStack;
+bool ASGraph::findProviderCycle(std::vector<int>& cycle) const {
+    cycle.clear();
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> rank;
+    uint32_t nodeCount = static_cast<uint32_t>(topology.size());
+    if (layerByCustomers(order, rank) == nodeCount) {
+        return false;
+    }
 
-    auto getCustomers = [](const ASNodePtr& node) -> const std::set<int>& {
-        return node->customers;
-    };
+    std::vector<bool> placed(nodeCount, false);
+    for (uint32_t index : order) {
+        placed[index] = true;
+    }
 
-    for (const auto& pair : nodes) {
-        int asn = pair.first;
-        if (visited.find(asn) == visited.end()) {
-            if (hasCycleDFS(asn, visited, recStack, getCustomers)) {
-                return true;
+    // Every unplaced AS still waits on an unplaced customer, so following
+    // those customers from any unplaced AS must come back around
+    uint32_t current = 0;
+    while (placed[current]) {
+        current++;
+    }
+    std::vector<bool> onWalk(nodeCount, false);
+    std::vector<uint32_t> walk;
+    while (!onWalk[current]) {
+        onWalk[current] = true;
+        walk.push_back(current);
+        for (uint32_t customer : topology.customers(current)) {
+            if (!placed[customer]) {
+                current = customer;
+                break;
             }
         }
     }
-    return false;
-}
 
-bool ASGraph::hasCustomerCycle() {
-    std::set<int> visited;
-    std::set<int> recStack;
+    auto first = std::find(walk.begin(), walk.end(), current);
+    for (auto it = first; it != walk.end(); ++it) {
+        cycle.push_back(topology.asns[*it]);
+    }
+    cycle.push_back(topology.asns[current]);
+    return true;
+}
 
-    auto getProviders = [](const ASNodePtr& node) -> const std::set<int>& {
-        return node->providers;
-    };
+bool ASGraph::hasProviderCycle() {
+    std::vector<int> cycle;
+    return findProviderCycle(cycle);
+}
 
-    for (const auto& pair : nodes) {
-        int asn = pair.first;
-        if (visited.find(asn) == visited.end()) {
-            if (hasCycleDFS(asn, visited, recStack, getProviders)) {
-                return true;
-            }
-        }
-    }
-    return false;
+// A customer cycle is a provider cycle walked backwards
+bool ASGraph::hasCustomerCycle() {
+    return hasProviderCycle();
 }
 
 void ASGraph::printStats() {
-    int totalProviderLinks = 0;
-    int totalCustomerLinks = 0;
-    int totalPeerLinks = 0;
-
-    for (const auto& pair : nodes) {
-        const ASNodePtr& node = pair.second;
-        totalProviderLinks += node->providers.size();
-        totalCustomerLinks += node->customers.size();
-        totalPeerLinks += node->peers.size();
-    }
+    size_t totalProviderLinks = topology.providerList.size();
+    size_t totalCustomerLinks = topology.customerList.size();
+    size_t totalPeerLinks = topology.peerList.size();
 
     std::cout << "AS Graph Statistics:" << std::endl;
     std::cout << "Total nodes: " << nodes.size() << std::endl;
@@ -150,306 +231,453 @@ void ASGraph::printStats() {
 
 void ASGraph::flattenGraph() {
     propagationRanks.clear();
-    
-    // Initialize ranks to -1 (unassigned)
-    std::unordered_map<int, int> rank;
-    for (const auto& pair : nodes) {
-        rank[pair.first] = -1;
-        pair.second->propagationRank = -1;
-    }
-    
-    // BFS queue for rank assignment (cycle-resistant)
-    std::queue<int> queue;
-    
-    // Step 1: Find all ASes with no customers (rank 0)
-    for (const auto& pair : nodes) {
-        if (pair.second->customers.empty()) {
-            rank[pair.first] = 0;
-            pair.second->propagationRank = 0;
-            queue.push(pair.first);
-        }
+    for (auto& node : nodes) {
+        node.propagationRank = -1;
     }
-    
-    // Step 2: BFS upward through providers (with cycle protection)
-    std::set<int> inQueue;
-    int maxIterations = nodes.size() * 3; // Reduced iteration limit
-    int iterations = 0;
-    
-    while (!queue.empty() && iterations < maxIterations) {
-        int currentASN = queue.front();
-        queue.pop();
-        inQueue.erase(currentASN);
-        
-        int currentRank = rank[currentASN];
-        
-        // For each provider, assign rank if it would be higher
-        for (int providerASN : nodes[currentASN]->providers) {
-            if (nodes.find(providerASN) != nodes.end()) {
-                if (rank[providerASN] < currentRank + 1) {
-                    rank[providerASN] = currentRank + 1;
-                    nodes[providerASN]->propagationRank = currentRank + 1;
-                    
-                    // Only add to queue if not already in queue
-                    if (inQueue.find(providerASN) == inQueue.end()) {
-                        queue.push(providerASN);
-                        inQueue.insert(providerASN);
-                    }
-                }
-            }
-        }
-        iterations++;
-    }
-    
-    // Step 3: Build propagation ranks vector
-    int maxRank = -1;
-    for (const auto& pair : rank) {
-        maxRank = std::max(maxRank, pair.second);
-    }
-    
-    if (maxRank >= 0) {
-        propagationRanks.resize(maxRank + 1);
-        for (const auto& pair : rank) {
-            int asn = pair.first;
-            int r = pair.second;
-            if (r >= 0) {
-                propagationRanks[r].push_back(asn);
-            }
+
+    // Nodes on or above a provider cycle have no well-defined rank
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> rank;
+    if (layerByCustomers(order, rank) != nodes.size()) {
+        std::cerr << "Cannot flatten graph: provider cycle detected" << std::endl;
+        return;
+    }
+
+    // Every AS is placed only after all of its customers, so rank is the
+    // exact longest customer chain below it. Count first so each rank's
+    // array is allocated once at its final size, then fill in index order.
+    std::vector<uint32_t> rankSizes;
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        nodes[index].propagationRank = static_cast<int>(rank[index]);
+        if (rank[index] >= rankSizes.size()) {
+            rankSizes.resize(rank[index] + 1, 0);
         }
+        rankSizes[rank[index]]++;
+    }
+
+    propagationRanks.resize(rankSizes.size());
+    for (size_t r = 0; r < rankSizes.size(); r++) {
+        propagationRanks[r].reserve(rankSizes[r]);
+    }
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        propagationRanks[rank[index]].push_back(index);
     }
 }
 
-void ASGraph::initializeBGPPolicies() {
-    for (auto& pair : nodes) {
-        pair.second->policy = std::make_unique<BGP>();
+void ASGraph::printRankStats() const {
+    if (propagationRanks.empty()) {
+        std::cout << "Propagation ranks: none (graph not flattened)" << std::endl;
+        return;
+    }
+
+    size_t largest = 0;
+    size_t smallest = 0;
+    for (size_t r = 0; r < propagationRanks.size(); r++) {
+        if (propagationRanks[r].size() > propagationRanks[largest].size()) largest = r;
+        if (propagationRanks[r].size() < propagationRanks[smallest].size()) smallest = r;
+    }
+
+    std::cout << "Propagation ranks: " << propagationRanks.size() << std::endl;
+    std::cout << "Mean ASes per rank: " << nodes.size() / propagationRanks.size() << std::endl;
+    std::cout << "Largest rank: " << largest << " (" << propagationRanks[largest].size() << " ASes)" << std::endl;
+    std::cout << "Smallest rank: " << smallest << " (" << propagationRanks[smallest].size() << " ASes)" << std::endl;
+    std::cout << "ASes per rank:";
+    for (size_t r = 0; r < propagationRanks.size(); r++) {
+        std::cout << (r == 0 ? " " : ", ") << propagationRanks[r].size();
     }
+    std::cout << std::endl;
+}
+
+void ASGraph::initializeBGPPolicies() {
+    // Same reset and reclassification as with ROV, so bgpPolicies never
+    // keeps pointing at the replaced policies
+    initializeBGPPolicies(std::set<int>());
 }
 
 void ASGraph::initializeBGPPolicies(const std::set<int>& rovASNs) {
-    for (auto& pair : nodes) {
-        int asn = pair.first;
-        if (rovASNs.find(asn) != rovASNs.end()) {
-            pair.second->policy = std::make_unique<ROV>();
+    for (auto& node : nodes) {
+        if (rovASNs.find(node.asn) != rovASNs.end()) {
+            node.policy = std::make_unique<ROV>();
         } else {
-            pair.second->policy = std::make_unique<BGP>();
+            node.policy = std::make_unique<BGP>();
         }
     }
+    implicitRIB.clear();
+    seeds.clear();
+    spill.reset();
+    ownerHopDeferred.clear();
+    spillFailed = false;
+    classifyPolicies();
 }
 
-void ASGraph::seedAnnouncement(int asn, const std::string& prefix) {
-    if (nodes.find(asn) != nodes.end() && nodes[asn]->policy) {
-        BGP* bgp = dynamic_cast<BGP*>(nodes[asn]->policy.get());
-        if (bgp) {
-            bgp->seedAnnouncement(prefix, asn);
+void ASGraph::classifyPolicies() {
+    policyKinds.assign(nodes.size(), PolicyKind::NONE);
+    bgpPolicies.assign(nodes.size(), nullptr);
+
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        Policy* policy = nodes[index].policy.get();
+        if (!policy) continue;
+
+        // Exact built-in types get compile-time kernels; subclasses might
+        // override behavior, so they keep virtual dispatch
+        if (typeid(*policy) == typeid(BGP)) {
+            policyKinds[index] = PolicyKind::BGP;
+        } else if (typeid(*policy) == typeid(ROV)) {
+            policyKinds[index] = PolicyKind::ROV;
+        } else if (dynamic_cast<BGP*>(policy)) {
+            policyKinds[index] = PolicyKind::CUSTOM;
+        }
+        if (policyKinds[index] != PolicyKind::NONE) {
+            bgpPolicies[index] = static_cast<BGP*>(policy);
         }
     }
 }
 
-void ASGraph::propagateAnnouncements() {
-    propagateUpward();
-    propagateAcross();
-    propagateDownward();
+void ASGraph::addToGroup(PolicyGroups& groups, PolicyKind kind, uint32_t index) {
+    switch (kind) {
+    case PolicyKind::BGP: groups.bgp.push_back(index); break;
+    case PolicyKind::ROV: groups.rov.push_back(index); break;
+    case PolicyKind::CUSTOM: groups.custom.push_back(index); break;
+    case PolicyKind::NONE: break;
+    }
 }
 
-void ASGraph::propagateUpward() {
-    for (int rank = 0; rank < propagationRanks.size(); rank++) {
-        // Send announcements to providers
-        for (int asn : propagationRanks[rank]) {
-            if (nodes.find(asn) == nodes.end()) continue;
-
-            BGP* senderBGP = dynamic_cast<BGP*>(nodes[asn]->policy.get());
-            if (!senderBGP) continue;
-
-            std::vector<Announcement> announcementsToSend = senderBGP->getAnnouncementsToSend();
-
-            for (int provider : nodes[asn]->providers) {
-                if (nodes.find(provider) == nodes.end()) continue;
-
-                BGP* receiverBGP = dynamic_cast<BGP*>(nodes[provider]->policy.get());
-                if (!receiverBGP) continue;
+void ASGraph::groupByPolicy() {
+    if (policyKinds.size() != nodes.size()) {
+        classifyPolicies();
+    }
+    markImplicitStubs();
+
+    // Implicit stubs never receive, so they are left out of every group
+    const auto& ranks = ranksToRun();
+    rankGroups.assign(ranks.size(), PolicyGroups());
+    for (size_t rank = 0; rank < ranks.size(); rank++) {
+        for (uint32_t index : ranks[rank]) {
+            if (hasImplicitRIB(index)) continue;
+            addToGroup(rankGroups[rank], policyKinds[index], index);
+        }
+    }
 
-                for (auto announcement : announcementsToSend) {
-                    // Don't send back to the AS we received it from
-                    if (announcement.nextHopASN == provider) continue;
+    allGroups = PolicyGroups();
+    auto addNode = [&](uint32_t index) {
+        if (!hasImplicitRIB(index)) addToGroup(allGroups, policyKinds[index], index);
+    };
+    if (scopedToRegion) {
+        for (uint32_t index : regionNodes) addNode(index);
+    } else {
+        for (uint32_t index = 0; index < nodes.size(); index++) addNode(index);
+    }
+}
 
-                    Announcement propagated = announcement.createPropagated(asn, Relationship::CUSTOMER);
-                    receiverBGP->addToReceivedQueue(propagated.prefix, propagated);
-                }
-            }
+void ASGraph::seedAnnouncement(int asn, const std::string& prefix, bool rovInvalid) {
+    ASNode* node = findNode(asn);
+    if (node && node->policy) {
+        BGP* bgp = dynamic_cast<BGP*>(node->policy.get());
+        if (bgp) {
+            PrefixId prefixId = prefixes.intern(prefix);
+            bgp->seedAnnouncement(prefixId, asn, rovInvalid, paths);
+            seeds.push_back({static_cast<uint32_t>(node - nodes.data()), prefixId, rovInvalid});
         }
+    }
+}
 
-        // Process received announcements for receivers (our working approach)
-        for (int asn : propagationRanks[rank]) {
-            if (nodes.find(asn) == nodes.end()) continue;
-
-            for (int provider : nodes[asn]->providers) {
-                if (nodes.find(provider) != nodes.end()) {
-                    BGP* providerBGP = dynamic_cast<BGP*>(nodes[provider]->policy.get());
-                    if (providerBGP) {
-                        providerBGP->processAnnouncements(provider);
-                    }
-                }
-            }
-        }
+bool ASGraph::propagateAnnouncements() {
+    groupByPolicy();
+    if (profiler) profiler->setWorkers(threadCount());
+
+    if (prefixShardCount > 1 && allGroups.custom.empty() && !scopedToRegion) {
+        propagateByPrefixShard();
+    } else if (engine == PropagationEngine::PULL || !spillFilename.empty()) {
+        pullUpward();
+        pullAcross();
+        pullDownward();
+    } else {
+        queuePools.assign(threadCount(), {});
+        propagateUpward();
+        propagateAcross();
+        propagateDownward();
+        queuePools.clear();
     }
+
+    if (paths.full()) {
+        std::cerr << "Error: a path store shard ran out of room during propagation; use fewer threads or "
+                  << "prefix shards" << std::endl;
+        return false;
+    }
+    return true;
 }
 
-void ASGraph::propagateAcross() {
-    // Send to peers
-    for (const auto& pair : nodes) {
-        int asn = pair.first;
-        BGP* senderBGP = dynamic_cast<BGP*>(pair.second->policy.get());
-        if (!senderBGP) continue;
+bool ASGraph::pathShardsFit(unsigned threads, unsigned shards) const {
+    if (static_cast<uint64_t>(std::max(1u, threads)) * std::max(1u, shards) > PathStore::MAX_SHARDS) {
+        std::cerr << "Error: " << threads << " threads x " << shards << " prefix shards needs more than "
+                  << PathStore::MAX_SHARDS << " path store shards" << std::endl;
+        return false;
+    }
+    return true;
+}
 
-        std::vector<Announcement> announcementsToSend = senderBGP->getAnnouncementsToSend();
+bool ASGraph::setThreadCount(unsigned threads) {
+    if (!pathShardsFit(threads, prefixShardCount)) return false;
+    if (threads <= 1) {
+        pool.reset();
+    } else {
+        pool = std::make_unique<ThreadPool>(threads);
+    }
+    resetPaths();
+    return true;
+}
 
-        for (int peer : pair.second->peers) {
-            if (nodes.find(peer) == nodes.end()) continue;
+bool ASGraph::setPrefixShards(unsigned shards) {
+    if (!pathShardsFit(threadCount(), shards)) return false;
+    prefixShardCount = std::max(1u, shards);
+    resetPaths();
+    return true;
+}
 
-            BGP* receiverBGP = dynamic_cast<BGP*>(nodes[peer]->policy.get());
-            if (!receiverBGP) continue;
+void ASGraph::resetPaths() {
+    // Each worker prepends into its own path shard; with prefix sharding,
+    // every prefix shard gets its own set of worker shards in this store
+    paths.reset(threadCount() * prefixShardCount);
+}
 
-            for (auto announcement : announcementsToSend) {
-                // Don't send back to the AS we received it from
-                if (announcement.nextHopASN == peer) continue;
+void ASGraph::runWorkers(const std::function<void(unsigned)>& task) {
+    if (pool) {
+        pool->run(task);
+    } else {
+        task(0);
+    }
+}
 
-                Announcement propagated = announcement.createPropagated(asn, Relationship::PEER);
-                receiverBGP->addToReceivedQueue(propagated.prefix, propagated);
-            }
-        }
+RouteCounts ASGraph::enqueueFrom(uint32_t sender, uint32_t receiver, Relationship relationship, unsigned worker) {
+    const BGP* senderBGP = bgpPolicies[sender];
+    BGP* receiverBGP = bgpPolicies[receiver];
+    int asn = nodes[sender].asn;
+    int receiverASN = nodes[receiver].asn;
+    RouteCounts counts;
+    if (receiverBGP && receiverBGP->receivedQueue.capacity() == 0) {
+        borrowQueue(receiverBGP->receivedQueue, worker);
     }
 
-    // Process received announcements
-    for (const auto& pair : nodes) {
-        int asn = pair.first;
-        BGP* bgp = dynamic_cast<BGP*>(pair.second->policy.get());
-        if (bgp) {
-            bgp->processAnnouncements(asn);
-        }
+    // Sender RIBs are read-only until every worker has finished sending
+    switch (policyKinds[receiver]) {
+    case PolicyKind::BGP:
+        counts = enqueueRoutes<false>(receiverBGP->receivedQueue, senderBGP->localRIB, asn, receiverASN,
+                                      relationship);
+        break;
+    case PolicyKind::ROV:
+        counts = enqueueRoutes<true>(receiverBGP->receivedQueue, senderBGP->localRIB, asn, receiverASN,
+                                     relationship);
+        break;
+    case PolicyKind::CUSTOM:
+        counts = offerToPolicy(sender, receiver, relationship);
+        break;
+    case PolicyKind::NONE:
+        break;
     }
+    return counts;
 }
 
-void ASGraph::propagateDownward() {
-    for (int rank = propagationRanks.size() - 1; rank >= 0; rank--) {
-        // Send announcements to customers
-        for (int asn : propagationRanks[rank]) {
-            if (nodes.find(asn) == nodes.end()) continue;
-
-            BGP* senderBGP = dynamic_cast<BGP*>(nodes[asn]->policy.get());
-            if (!senderBGP) continue;
+// Custom policies see every offer through the Policy interface and decide
+// for themselves in addToReceivedQueue and processAnnouncements. Both
+// engines use this, so a subclass behaves the same under either.
+RouteCounts ASGraph::offerToPolicy(uint32_t sender, uint32_t receiver, Relationship relationship) {
+    Policy* receiverPolicy = nodes[receiver].policy.get();
+    int asn = nodes[sender].asn;
+    int receiverASN = nodes[receiver].asn;
+    RouteCounts counts;
+    for (const auto& announcement : bgpPolicies[sender]->localRIB) {
+        // Don't send back to the AS we received it from
+        if (announcement.nextHopASN == receiverASN) continue;
+
+        Announcement propagated = announcement.createPropagated(asn, relationship);
+        receiverPolicy->addToReceivedQueue(propagated.prefixId, propagated);
+        counts.sent++;
+    }
+    return counts;
+}
 
-            std::vector<Announcement> announcementsToSend = senderBGP->getAnnouncementsToSend();
+void ASGraph::processReceived(uint32_t index, PathShard& shard, unsigned worker) {
+    switch (policyKinds[index]) {
+    case PolicyKind::BGP:
+    case PolicyKind::ROV: {
+        // Filtering already happened on enqueue; skip the vtable
+        RouteCounts counts = bgpPolicies[index]->processReceivedQueue(nodes[index].asn, shard);
+        if (profiler) profiler->counts(worker) += counts;
+        break;
+    }
+    case PolicyKind::CUSTOM:
+        bgpPolicies[index]->processAnnouncements(nodes[index].asn, shard);
+        break;
+    case PolicyKind::NONE:
+        return;
+    }
+    returnQueue(bgpPolicies[index]->receivedQueue, worker);
+}
 
-            for (int customer : nodes[asn]->customers) {
-                if (nodes.find(customer) == nodes.end()) continue;
+// Receive queues are drained right after they are filled, so each worker
+// recycles a small set of buffers instead of growing a fresh vector for
+// every receiver
+void ASGraph::borrowQueue(std::vector<Announcement>& queue, unsigned worker) {
+    std::vector<std::vector<Announcement>>& spares = queuePools[worker];
+    if (!spares.empty()) {
+        queue.swap(spares.back());
+        spares.pop_back();
+    }
+}
 
-                BGP* receiverBGP = dynamic_cast<BGP*>(nodes[customer]->policy.get());
-                if (!receiverBGP) continue;
+void ASGraph::returnQueue(std::vector<Announcement>& queue, unsigned worker) {
+    if (queue.capacity() == 0) return;
+    queue.clear();
+    queuePools[worker].push_back(std::move(queue));
+    queue = std::vector<Announcement>();
+}
 
-                for (auto announcement : announcementsToSend) {
-                    // Don't send back to the AS we received it from
-                    if (announcement.nextHopASN == customer) continue;
+void ASGraph::propagateUpward() {
+    const auto& ranks = ranksToRun();
+    for (size_t rank = 0; rank < ranks.size(); rank++) {
+        ScopedPhase phase(profiler, profiler ? "up.rank" + std::to_string(rank) : std::string());
+        pushAlong(collectRankEdges(ranks[rank], &Topology::providers), Relationship::CUSTOMER);
+    }
+}
 
-                    Announcement propagated = announcement.createPropagated(asn, Relationship::PROVIDER);
-                    receiverBGP->addToReceivedQueue(propagated.prefix, propagated);
-                }
-            }
+ASGraph::ReceiverEdges ASGraph::collectPeerEdges() const {
+    ReceiverEdges edges;
+    edges.senderOffsets.push_back(0);
+    std::vector<size_t> work;  // routes offered up to and including each receiver
+    size_t total = 0;
+    auto addReceiver = [&](uint32_t receiver) {
+        // Implicit stubs have no peers, so they never appear on either side
+        if (policyKinds[receiver] == PolicyKind::NONE) return;
+
+        size_t before = edges.senders.size();
+        for (uint32_t sender : topology.peers(receiver)) {
+            const BGP* senderBGP = bgpPolicies[sender];
+            if (!senderBGP || senderBGP->localRIB.empty()) continue;
+            edges.senders.push_back(sender);
+            total += senderBGP->localRIB.size();
         }
+        if (edges.senders.size() == before) return;
 
-        // Process received announcements for receivers (our working approach)  
-        for (int asn : propagationRanks[rank]) {
-            if (nodes.find(asn) == nodes.end()) continue;
-
-            for (int customer : nodes[asn]->customers) {
-                if (nodes.find(customer) != nodes.end()) {
-                    BGP* customerBGP = dynamic_cast<BGP*>(nodes[customer]->policy.get());
-                    if (customerBGP) {
-                        customerBGP->processAnnouncements(customer);
-                    }
-                }
-            }
-        }
+        edges.receivers.push_back(receiver);
+        edges.senderOffsets.push_back(static_cast<uint32_t>(edges.senders.size()));
+        work.push_back(total);
+    };
+    if (scopedToRegion) {
+        for (uint32_t receiver : regionNodes) addReceiver(receiver);
+    } else {
+        for (uint32_t receiver = 0; receiver < nodes.size(); receiver++) addReceiver(receiver);
     }
+    sliceByWork(edges, work);
+    return edges;
 }
 
-void ASGraph::outputToCSV(const std::string& filename) {
-    std::ofstream file(filename);
-    file << "asn,prefix,as_path" << std::endl;
-
-    for (const auto& pair : nodes) {
-        int asn = pair.first;
-        BGP* bgp = dynamic_cast<BGP*>(pair.second->policy.get());
-        if (!bgp) continue;
-
-        for (const auto& ribEntry : bgp->localRIB) {
-            const std::string& prefix = ribEntry.first;
-            const Announcement& announcement = ribEntry.second;
+// Turns the sender-side lists of one rank around: one pass counts the edges
+// of every receiver, a second places each sender, keeping rank order
+ASGraph::ReceiverEdges ASGraph::collectRankEdges(const std::vector<uint32_t>& senders, NeighborFn receiversOf) {
+    const uint32_t unset = std::numeric_limits<uint32_t>::max();
+    if (edgeSlots.size() != nodes.size()) edgeSlots.assign(nodes.size(), unset);
 
-            file << asn << "," << prefix << ",\"(";
-            for (size_t i = 0; i < announcement.asPath.size(); i++) {
-                if (i > 0) file << ", ";
-                file << announcement.asPath[i];
+    ReceiverEdges edges;
+    auto sends = [&](uint32_t sender) {
+        return bgpPolicies[sender] && !bgpPolicies[sender]->localRIB.empty();
+    };
+    auto receives = [&](uint32_t receiver) {
+        return policyKinds[receiver] != PolicyKind::NONE && !hasImplicitRIB(receiver);
+    };
+    std::vector<size_t> work;  // routes offered to each receiver
+    for (uint32_t sender : senders) {
+        if (!sends(sender)) continue;
+        for (uint32_t receiver : (topology.*receiversOf)(sender)) {
+            if (!receives(receiver)) continue;
+            if (edgeSlots[receiver] == unset) {
+                edgeSlots[receiver] = static_cast<uint32_t>(edges.receivers.size());
+                edges.receivers.push_back(receiver);
+                edges.senderOffsets.push_back(0);
+                work.push_back(0);
             }
-            if (announcement.asPath.size() == 1) file << ",";
-            file << ")\"" << std::endl;
+            edges.senderOffsets[edgeSlots[receiver]]++;
+            work[edgeSlots[receiver]] += bgpPolicies[sender]->localRIB.size();
         }
     }
 
-    file.close();
+    // Counts become end offsets; placing the senders back to front steps
+    // each offset down to the start of its receiver's run
+    uint32_t end = 0;
+    size_t total = 0;
+    for (size_t slot = 0; slot < edges.receivers.size(); slot++) {
+        end += edges.senderOffsets[slot];
+        edges.senderOffsets[slot] = end;
+        total += work[slot];
+        work[slot] = total;
+    }
+    edges.senderOffsets.push_back(end);
+    edges.senders.resize(end);
+    for (size_t i = senders.size(); i-- > 0;) {
+        uint32_t sender = senders[i];
+        if (!sends(sender)) continue;
+        NeighborRange receivers = (topology.*receiversOf)(sender);
+        for (size_t j = receivers.size(); j-- > 0;) {
+            uint32_t receiver = receivers.first[j];
+            if (receives(receiver)) edges.senders[--edges.senderOffsets[edgeSlots[receiver]]] = sender;
+        }
+    }
+
+    for (uint32_t receiver : edges.receivers) edgeSlots[receiver] = unset;
+    sliceByWork(edges, work);
+    return edges;
 }
 
-bool ASGraph::loadAnnouncementsFromCSV(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error opening announcements file: " << filename << std::endl;
-        return false;
+// Cut the receivers where the running total of routes crosses each worker's
+// share, so a few heavily connected ASes do not land on one thread
+void ASGraph::sliceByWork(ReceiverEdges& edges, const std::vector<size_t>& work) const {
+    unsigned workers = threadCount();
+    size_t total = work.empty() ? 0 : work.back();
+    edges.workerSlices.assign(workers + 1, edges.receivers.size());
+    edges.workerSlices[0] = 0;
+    size_t slot = 0;
+    for (unsigned worker = 1; worker < workers; worker++) {
+        size_t share = total / workers * worker;
+        while (slot < work.size() && work[slot] < share) slot++;
+        edges.workerSlices[worker] = slot;
     }
+}
 
-    std::string line;
-    bool firstLine = true;
-
-    while (std::getline(file, line)) {
-        if (firstLine) {
-            firstLine = false;
-            continue; // Skip header
+// Every sender enqueues before any receiver processes, so routes move
+// exactly one hop per call
+void ASGraph::pushAlong(const ReceiverEdges& edges, Relationship relationship) {
+    runWorkers([&](unsigned worker) {
+        RouteCounts counts;
+        for (size_t slot = edges.workerSlices[worker]; slot < edges.workerSlices[worker + 1]; slot++) {
+            for (uint32_t sender : edges.sendersOf(slot)) {
+                counts += enqueueFrom(sender, edges.receivers[slot], relationship, worker);
+            }
         }
-
-        if (line.empty()) continue;
-
-        // Remove carriage return if present (Windows line endings)
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+        if (profiler) profiler->counts(worker) += counts;
+    });
+    runWorkers([&](unsigned worker) {
+        PathShard& shard = pathShard(worker);
+        for (size_t slot = edges.workerSlices[worker]; slot < edges.workerSlices[worker + 1]; slot++) {
+            processReceived(edges.receivers[slot], shard, worker);
         }
+    });
+}
 
-        std::istringstream iss(line);
-        std::string asnStr, prefix, rovInvalidStr;
-
-        if (std::getline(iss, asnStr, ',') &&
-            std::getline(iss, prefix, ',') &&
-            std::getline(iss, rovInvalidStr)) {
+void ASGraph::propagateAcross() {
+    ScopedPhase phase(profiler, "across");
+    ReceiverEdges edges = collectPeerEdges();
+    if (profiler) profiler->addEdges(edges.senders.size());
 
-            // Remove any trailing whitespace/carriage returns
-            if (!rovInvalidStr.empty() && rovInvalidStr.back() == '\r') {
-                rovInvalidStr.pop_back();
-            }
+    // Every AS sends to its peers before any of them processes, so routes
+    // learned from a peer are never passed on to another peer
+    pushAlong(edges, Relationship::PEER);
+}
 
-            int asn = std::stoi(asnStr);
-            bool rovInvalid = (rovInvalidStr == "true" || rovInvalidStr == "True" ||
-                              rovInvalidStr == "false" || rovInvalidStr == "False") ?
-                              (rovInvalidStr == "true" || rovInvalidStr == "True") :
-                              (rovInvalidStr == "1");
-
-            // Ensure the AS exists in our graph
-            if (nodes.find(asn) != nodes.end() && nodes[asn]->policy) {
-                BGP* bgp = dynamic_cast<BGP*>(nodes[asn]->policy.get());
-                if (bgp) {
-                    bgp->seedAnnouncement(prefix, asn, rovInvalid);
-                }
-            }
-        }
+void ASGraph::propagateDownward() {
+    const auto& ranks = ranksToRun();
+    for (size_t rank = ranks.size(); rank-- > 0;) {
+        ScopedPhase phase(profiler, profiler ? "down.rank" + std::to_string(rank) : std::string());
+        pushAlong(collectRankEdges(ranks[rank], &Topology::customers), Relationship::PROVIDER);
     }
-
-    file.close();
-    return true;
 }
 
 bool ASGraph::loadROVASNs(const std::string& filename, std::set<int>& rovASNs) {
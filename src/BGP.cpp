@@ -1,104 +1,88 @@
 #include "Policy.h"
-#include <algorithm>
+#include "RouteKernels.h"
 
-void BGP::processAnnouncements(int currentASN) {
-    for (auto& entry : receivedQueue) {
-        const std::string& prefix = entry.first;
-        std::vector<Announcement>& announcements = entry.second;
+void BGP::processAnnouncements(int currentASN, PathShard& paths) {
+    processReceivedQueue(currentASN, paths);
+}
 
-        if (!announcements.empty()) {
-            // Create candidates with prepended AS paths for accurate comparison
-            std::vector<Announcement> candidates;
-            for (const auto& ann : announcements) {
-                Announcement candidate = ann;
-                candidate.asPath.insert(candidate.asPath.begin(), currentASN);
-                candidates.push_back(candidate);
-            }
-            
-            // Select best among prepended candidates
-            Announcement best = selectBestAnnouncement(candidates);
-            
-            // Compare with existing route if any
-            auto it = localRIB.find(prefix);
-            if (it == localRIB.end() || isBetterThan(best, it->second)) {
-                localRIB[prefix] = best;
-            }
-        }
+RouteCounts BGP::processReceivedQueue(int currentASN, PathShard& paths) {
+    // The decision process is a strict total order, so selecting the best
+    // candidate per prefix first and then comparing it with the RIB entry
+    // picks the same winner as folding the queue in order, and only the
+    // winners get a path node. Keys account for our own ASN in the length.
+    CandidateTable& table = CandidateTable::local();
+    for (const auto& announcement : receivedQueue) {
+        table.offer(announcement.prefixId,
+                    Announcement::decisionKey(announcement.receivedFrom, announcement.pathLength + 1,
+                                              announcement.nextHopASN),
+                    announcement);
     }
+    RouteCounts counts = commitCandidates(table, localRIB, currentASN, paths);
 
     receivedQueue.clear();
+    return counts;
 }
 
-void BGP::addToReceivedQueue(const std::string& prefix, const Announcement& announcement) {
-    receivedQueue[prefix].push_back(announcement);
+void BGP::addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) {
+    receivedQueue.push_back(announcement);
+    receivedQueue.back().prefixId = prefixId;
 }
 
 std::vector<Announcement> BGP::getAnnouncementsToSend() {
-    std::vector<Announcement> announcements;
-    for (const auto& entry : localRIB) {
-        announcements.push_back(entry.second);
-    }
-    return announcements;
+    return std::vector<Announcement>(localRIB.begin(), localRIB.end());
 }
 
-void BGP::seedAnnouncement(const std::string& prefix, int originASN) {
-    seedAnnouncement(prefix, originASN, false);
+void BGP::seedAnnouncement(PrefixId prefixId, int originASN, PathStore& paths) {
+    seedAnnouncement(prefixId, originASN, false, paths);
 }
 
-void BGP::seedAnnouncement(const std::string& prefix, int originASN, bool rovInvalid) {
+void BGP::seedAnnouncement(PrefixId prefixId, int originASN, bool rovInvalid, PathStore& paths) {
     Announcement announcement;
-    announcement.prefix = prefix;
-    announcement.asPath = {originASN};
+    announcement.prefixId = prefixId;
+    announcement.asPath = paths.prepend(originASN, PathStore::EMPTY);
+    announcement.pathLength = 1;
     announcement.nextHopASN = originASN;
     announcement.receivedFrom = Relationship::ORIGIN;
     announcement.rovInvalid = rovInvalid;
 
-    localRIB[prefix] = announcement;
+    localRIB.insertOrAssign(announcement);
 }
 
-Announcement BGP::selectBestAnnouncement(const std::vector<Announcement>& announcements) {
-    if (announcements.empty()) {
-        return Announcement();
-    }
-
-    if (announcements.size() == 1) {
-        return announcements[0];
-    }
-
-    // Use ex2_-style BGP decision process
-    auto best = announcements[0];
+void BGP::receiveFrom(const BGP& neighbor, int neighborASN, Relationship relationship,
+                      int currentASN, PathShard& paths) {
+    receiveInto(localRIB, neighbor.localRIB, neighborASN, relationship, currentASN, paths);
+}
 
-    for (const auto& announcement : announcements) {
-        if (announcement.isBetterThan(best)) {
-            best = announcement;
-        }
+RouteCounts BGP::receiveInto(RIB& target, const RIB& neighborRIB, int neighborASN, Relationship relationship,
+                             int currentASN, PathShard& paths) const {
+    if (dropsInvalid()) {
+        return receiveRoutes<true>(target, neighborRIB, neighborASN, relationship, currentASN, paths);
     }
-
-    return best;
+    return receiveRoutes<false>(target, neighborRIB, neighborASN, relationship, currentASN, paths);
 }
 
-bool BGP::isBetterThan(const Announcement& candidate, const Announcement& existing) {
+bool BGP::isBetterThan(const Announcement& candidate, const Announcement& existing) const {
     // Use announcement's own comparison method
     return candidate.isBetterThan(existing);
 }
 
 // ROV Implementation
-void ROV::addToReceivedQueue(const std::string& prefix, const Announcement& announcement) {
+void ROV::addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) {
     // Drop announcements with ROV invalid flag set to true
     if (announcement.rovInvalid) {
         return; // Drop the announcement
     }
 
     // Otherwise, use the standard BGP behavior
-    BGP::addToReceivedQueue(prefix, announcement);
+    BGP::addToReceivedQueue(prefixId, announcement);
 }
 
-void ROV::seedAnnouncement(const std::string& prefix, int originASN, bool rovInvalid) {
+void ROV::seedAnnouncement(PrefixId prefixId, int originASN, bool rovInvalid, PathStore& paths) {
     // ROV-enabled ASNs should not seed invalid announcements
     if (rovInvalid) {
         return; // Drop the announcement
     }
 
     // Otherwise, use the standard BGP behavior
-    BGP::seedAnnouncement(prefix, originASN, rovInvalid);
+    BGP::seedAnnouncement(prefixId, originASN, rovInvalid, paths);
 }
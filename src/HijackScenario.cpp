@@ -0,0 +1,231 @@
+#include "HijackScenario.h"
+#include "Policy.h"
+#include <fstream>
+#include <memory>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+bool crosses(const PathStore& paths, PathRef path, int asn) {
+    for (; path != PathStore::EMPTY; path = paths.parent(path)) {
+        if (paths.head(path) == asn) return true;
+    }
+    return false;
+}
+
+// The engines only refuse to send a route back to its next hop, which is
+// enough for valley-free routes from an origin. A leaked route can climb
+// back to the ASes it came through, so those check the whole path.
+template <class Base>
+class LoopCheck : public Base {
+public:
+    LoopCheck(int asn, const PathStore& paths) : asn(asn), paths(paths) {}
+
+    void addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) override {
+        if (crosses(paths, announcement.asPath, asn)) return;
+        Base::addToReceivedQueue(prefixId, announcement);
+    }
+
+private:
+    int asn;
+    const PathStore& paths;
+};
+
+} // namespace
+
+bool HijackScenario::run(ASGraph& graph, const std::set<int>& rovASNs) {
+    if (victimASN == attackerASN) {
+        std::cerr << "Hijack victim and attacker must be different ASes (AS" << victimASN << ")" << std::endl;
+        return false;
+    }
+    if (prefix.empty() || (type == HijackType::SUBPREFIX && (subprefix.empty() || subprefix == prefix))) {
+        std::cerr << "Hijack needs a prefix and, for a subprefix hijack, a different subprefix" << std::endl;
+        return false;
+    }
+
+    if (type == HijackType::LEAK) {
+        std::vector<int> path;
+        if (!leakedPath(graph, rovASNs, path)) {
+            return false;
+        }
+        seedLeak(graph, rovASNs, path);
+        if (!graph.propagateAnnouncements()) {
+            return false;
+        }
+        countOutcomes(graph);
+        return true;
+    }
+
+    // ROV would drop the attacker's own invalid seed and the hijack would
+    // never start, so the attacker always runs plain BGP. It is left out of
+    // the counts either way.
+    graph.resetRoutingState();
+    if (rovASNs.count(attackerASN)) {
+        std::cerr << "Warning: hijack attacker AS" << attackerASN << " is in the ROV set; it runs plain BGP"
+                  << std::endl;
+        std::set<int> adopters(rovASNs);
+        adopters.erase(attackerASN);
+        graph.initializeBGPPolicies(adopters);
+    } else {
+        graph.initializeBGPPolicies(rovASNs);
+    }
+    for (int asn : {victimASN, attackerASN}) {
+        ASNode* node = graph.findNode(asn);
+        if (!node || !dynamic_cast<BGP*>(node->policy.get())) {
+            std::cerr << "Hijack origin AS" << asn << " is not in the topology" << std::endl;
+            return false;
+        }
+    }
+
+    graph.seedAnnouncement(victimASN, prefix, false);
+    graph.seedAnnouncement(attackerASN, type == HijackType::SUBPREFIX ? subprefix : prefix, true);
+    if (!graph.propagateAnnouncements()) {
+        return false;
+    }
+    countOutcomes(graph);
+    return true;
+}
+
+// Propagates the victim alone and returns the path the attacker would leak,
+// starting with the attacker itself
+bool HijackScenario::leakedPath(ASGraph& graph, const std::set<int>& rovASNs, std::vector<int>& path) const {
+    graph.resetRoutingState();
+    graph.initializeBGPPolicies(rovASNs);
+    ASNode* leaker = graph.findNode(attackerASN);
+    for (int asn : {victimASN, attackerASN}) {
+        ASNode* node = graph.findNode(asn);
+        if (!node || !dynamic_cast<BGP*>(node->policy.get())) {
+            std::cerr << "Leak AS" << asn << " is not in the topology" << std::endl;
+            return false;
+        }
+    }
+    uint32_t index = static_cast<uint32_t>(leaker - graph.nodes.data());
+    if (graph.topology.providers(index).size() + graph.topology.peers(index).size() < 2) {
+        std::cerr << "Leaker AS" << attackerASN << " has fewer than two providers and peers to leak between"
+                  << std::endl;
+        return false;
+    }
+
+    graph.seedAnnouncement(victimASN, prefix, false);
+    if (!graph.propagateAnnouncements()) {
+        return false;
+    }
+    PrefixId prefixId = 0;
+    graph.prefixes.find(prefix, prefixId);
+    const Announcement* route = graph.routeFor(index, prefixId);
+    if (!route) {
+        std::cerr << "Leaker AS" << attackerASN << " has no route to " << prefix << std::endl;
+        return false;
+    }
+    if (route->receivedFrom == Relationship::CUSTOMER) {
+        std::cerr << "Leaker AS" << attackerASN << " learns " << prefix
+                  << " from a customer and already exports it to everyone" << std::endl;
+        return false;
+    }
+    path = graph.paths.toVector(route->asPath);
+    return true;
+}
+
+// Seeds the victim and, at the attacker, the leaked route as if it were its
+// own. The ASes on the leaked path drop any route that would loop back.
+void HijackScenario::seedLeak(ASGraph& graph, const std::set<int>& rovASNs, const std::vector<int>& path) const {
+    graph.resetRoutingState();
+    graph.initializeBGPPolicies(rovASNs);
+    for (size_t i = 1; i < path.size(); i++) {
+        ASNode* node = graph.findNode(path[i]);
+        if (rovASNs.count(path[i])) {
+            node->policy = std::make_unique<LoopCheck<ROV>>(path[i], graph.paths);
+        } else {
+            node->policy = std::make_unique<LoopCheck<BGP>>(path[i], graph.paths);
+        }
+    }
+    graph.classifyPolicies();
+
+    graph.seedAnnouncement(victimASN, prefix, false);
+    PrefixId prefixId = graph.prefixes.intern(prefix);
+    PathRef leaked = PathStore::EMPTY;
+    for (size_t i = path.size(); i-- > 0;) {
+        leaked = graph.paths.prepend(path[i], leaked);
+    }
+    BGP* leaker = static_cast<BGP*>(graph.findNode(attackerASN)->policy.get());
+    leaker->localRIB.insertOrAssign(Announcement(prefixId, leaked, static_cast<uint32_t>(path.size()), attackerASN,
+                                                 Relationship::ORIGIN));
+}
+
+void HijackScenario::countOutcomes(const ASGraph& graph) {
+    rov = OutcomeCounts();
+    bgp = OutcomeCounts();
+
+    PrefixId prefixId = 0;
+    PrefixId subprefixId = 0;
+    graph.prefixes.find(prefix, prefixId);
+    bool subprefixSeen = type == HijackType::SUBPREFIX && graph.prefixes.find(subprefix, subprefixId);
+
+    for (uint32_t index = 0; index < graph.nodes.size(); index++) {
+        const ASNode& node = graph.nodes[index];
+        const BGP* policy = dynamic_cast<const BGP*>(node.policy.get());
+        if (!policy || node.asn == victimASN || node.asn == attackerASN) continue;
+
+        // Forwarding follows the longest matching prefix
+        const Announcement* route = subprefixSeen ? graph.routeFor(index, subprefixId) : nullptr;
+        if (!route) route = graph.routeFor(index, prefixId);
+
+        OutcomeCounts& counts = policy->dropsInvalid() ? rov : bgp;
+        int origin = route ? graph.paths.origin(route->asPath) : 0;
+        if (route && type == HijackType::LEAK) {
+            (crosses(graph.paths, route->asPath, attackerASN) ? counts.attacker : counts.victim)++;
+        } else if (route && origin == attackerASN) {
+            counts.attacker++;
+        } else if (route && origin == victimASN) {
+            counts.victim++;
+        } else {
+            counts.neither++;
+        }
+    }
+}
+
+void HijackScenario::printSummary() const {
+    if (type == HijackType::LEAK) {
+        std::cout << "Route leak of AS" << victimASN << "'s prefix by AS" << attackerASN << ":" << std::endl;
+    } else {
+        std::cout << (type == HijackType::SUBPREFIX ? "Subprefix" : "Prefix") << " hijack of AS" << victimASN
+                  << " by AS" << attackerASN << ":" << std::endl;
+    }
+    std::cout << "  " << std::left << std::setw(10) << "adoption" << std::right << std::setw(10) << "ases"
+              << std::setw(12) << "attacker" << std::setw(12) << "victim" << std::setw(12) << "neither" << std::endl;
+    auto row = [](const char* name, const OutcomeCounts& counts) {
+        std::cout << "  " << std::left << std::setw(10) << name << std::right << std::setw(10) << counts.total()
+                  << std::fixed << std::setprecision(4) << std::setw(12) << counts.fraction(counts.attacker)
+                  << std::setw(12) << counts.fraction(counts.victim) << std::setw(12)
+                  << counts.fraction(counts.neither) << std::endl;
+    };
+    row("rov", rov);
+    row("bgp", bgp);
+    row("all", all());
+}
+
+bool HijackScenario::writeCSV(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening output file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "adoption,ases,attacker,victim,neither,attacker_fraction,victim_fraction,neither_fraction\n";
+    file << std::fixed << std::setprecision(6);
+    auto row = [&](const char* name, const OutcomeCounts& counts) {
+        file << name << ',' << counts.total() << ',' << counts.attacker << ',' << counts.victim << ','
+             << counts.neither << ',' << counts.fraction(counts.attacker) << ',' << counts.fraction(counts.victim)
+             << ',' << counts.fraction(counts.neither) << '\n';
+    };
+    row("rov", rov);
+    row("bgp", bgp);
+    row("all", all());
+
+    if (!file.good()) {
+        std::cerr << "Error writing output file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
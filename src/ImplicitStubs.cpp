@@ -0,0 +1,91 @@
+#include "ASGraph.h"
+#include "RouteKernels.h"
+
+// Implicit stub RIBs. Most ASes are stubs with a single provider: every route
+// they hold is one of the provider's routes with the stub prepended, minus
+// invalid ones for ROV. Nothing else reads a stub's RIB during propagation
+// (it has no customers or peers, and without seeds it sends its provider
+// nothing), so the copy is skipped and derived again only when it is needed.
+
+void ASGraph::setImplicitStubs(bool enabled) {
+    if (!enabled) {
+        materializeImplicitRIBs();
+    }
+    implicitStubs = enabled;
+}
+
+void ASGraph::markImplicitStubs() {
+    if (!implicitStubs || !implicitRIB.empty()) return;
+
+    implicitRIB.assign(nodes.size(), 0);
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        // Custom policies may decide differently from their provider
+        if (policyKinds[index] != PolicyKind::BGP && policyKinds[index] != PolicyKind::ROV) continue;
+        if (!topology.customers(index).empty() || !topology.peers(index).empty()) continue;
+
+        NeighborRange providers = topology.providers(index);
+        if (providers.size() != 1 || !bgpPolicies[*providers.begin()]) continue;
+
+        // A seeded stub announces to its provider, so it must propagate
+        if (!bgpPolicies[index]->localRIB.empty()) continue;
+
+        implicitRIB[index] = 1;
+    }
+}
+
+void ASGraph::materializeImplicitRIB(uint32_t index, PathShard& shard) {
+    const NeighborRange providers = topology.providers(index);
+    uint32_t provider = *providers.begin();
+    RIB& target = bgpPolicies[index]->localRIB;
+    if (policyKinds[index] == PolicyKind::ROV) {
+        receiveRoutes<true>(target, providerRIB(index), nodes[provider].asn, Relationship::PROVIDER,
+                            nodes[index].asn, shard);
+    } else {
+        receiveRoutes<false>(target, providerRIB(index), nodes[provider].asn, Relationship::PROVIDER,
+                             nodes[index].asn, shard);
+    }
+    implicitRIB[index] = 0;
+}
+
+void ASGraph::materializeImplicitRIBs() {
+    if (implicitRIB.empty()) return;
+
+    // Providers are never implicit, so every source RIB is already final
+    runWorkers([&](unsigned worker) {
+        PathShard& shard = pathShard(worker);
+        for (uint32_t index = worker; index < nodes.size(); index += threadCount()) {
+            if (implicitRIB[index]) materializeImplicitRIB(index, shard);
+        }
+    });
+    implicitRIB.clear();
+}
+
+size_t ASGraph::rowCount(uint32_t index) const {
+    if (spill && spill->holds(index)) return spill->rowCount(index);
+    const BGP* bgp = dynamic_cast<const BGP*>(nodes[index].policy.get());
+    if (!bgp) return 0;
+    if (!hasImplicitRIB(index)) return bgp->localRIB.size();
+
+    size_t total = 0;
+    for (const auto& route : providerRIB(index)) {
+        if (inheritsRoute(index, route)) total++;
+    }
+    return total;
+}
+
+const Announcement* ASGraph::routeFor(uint32_t index, PrefixId prefixId) const {
+    const BGP* bgp = dynamic_cast<const BGP*>(nodes[index].policy.get());
+    if (!bgp) return nullptr;
+    if (!hasImplicitRIB(index)) return bgp->localRIB.find(prefixId);
+
+    const Announcement* route = providerRIB(index).find(prefixId);
+    return route && inheritsRoute(index, *route) ? route : nullptr;
+}
+
+size_t ASGraph::routeCount() const {
+    size_t total = 0;
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        total += rowCount(index);
+    }
+    return total;
+}
@@ -0,0 +1,124 @@
+#include "PathStore.h"
+#include <iostream>
+
+namespace {
+
+const uint32_t INITIAL_INDEX_SLOTS = 1024;
+
+uint64_t slotOf(uint64_t key, uint64_t mask) {
+    return (key * 0x9E3779B97F4A7C15ull >> 29) & mask;
+}
+
+} // namespace
+
+PathShard::PathShard(const PathStore& store, PathRef base, uint64_t capacity)
+    : store(store), base(base), count(0), full(false), chunks((capacity + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      index(INITIAL_INDEX_SLOTS, Slot{0, 0}), indexMask(INITIAL_INDEX_SLOTS - 1), indexed(0) {}
+
+void PathShard::growIndex() {
+    std::vector<Slot> old(index.size() * 2, Slot{0, 0});
+    old.swap(index);
+    indexMask = index.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.ref == 0) continue;
+        uint64_t i = slotOf(slot.key, indexMask);
+        while (index[i].ref != 0) i = (i + 1) & indexMask;
+        index[i] = slot;
+    }
+}
+
+PathRef PathShard::prepend(int asn, PathRef parent) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(asn)) << 32) | parent;
+    uint64_t i = slotOf(key, indexMask);
+    for (; index[i].ref != 0; i = (i + 1) & indexMask) {
+        if (index[i].key == key) {
+            return index[i].ref;
+        }
+    }
+
+    uint32_t chunk = count >> CHUNK_BITS;
+    if (chunk >= chunks.size()) {
+        // Workers cannot fail mid-phase, so the run is flagged and reported
+        // once propagation returns
+        full = true;
+        return parent;
+    }
+    if (!chunks[chunk]) {
+        chunks[chunk] = std::make_unique<Node[]>(CHUNK_SIZE);
+    }
+
+    uint32_t length = (parent == PathStore::EMPTY) ? 0 : store.length(parent);
+    chunks[chunk][count & (CHUNK_SIZE - 1)] = {asn, parent, length + 1};
+
+    PathRef ref = base | count++;
+    index[i] = {key, ref};
+    // Keep the table at most half full so probe runs stay short
+    if (++indexed * 2 > index.size()) {
+        growIndex();
+    }
+    return ref;
+}
+
+PathStore::PathStore(unsigned shardCount) {
+    reset(shardCount);
+}
+
+std::vector<int> PathStore::toVector(PathRef path) const {
+    std::vector<int> asPath;
+    asPath.reserve(length(path));
+    for (; path != EMPTY; path = parent(path)) {
+        asPath.push_back(head(path));
+    }
+    return asPath;
+}
+
+size_t PathStore::size() const {
+    size_t total = 0;
+    for (const auto& s : shards) {
+        total += s->count;
+    }
+    return total;
+}
+
+bool PathStore::full() const {
+    for (const auto& s : shards) {
+        if (s->full) return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> PathStore::denseOffsets() const {
+    std::vector<uint32_t> offsets;
+    offsets.reserve(shards.size());
+    uint32_t total = 0;
+    for (const auto& s : shards) {
+        offsets.push_back(total);
+        total += s->count;
+    }
+    return offsets;
+}
+
+void PathStore::reset(unsigned shardCount) {
+    if (shardCount == 0) {
+        shardCount = 1;
+    }
+
+    unsigned shardBits = 0;
+    while ((1u << shardBits) < shardCount) {
+        shardBits++;
+    }
+    shardShift = 32 - shardBits;
+    indexMask = (uint64_t(1) << shardShift) - 1;
+
+    shards.clear();
+    for (unsigned i = 0; i < shardCount; i++) {
+        PathRef base = static_cast<PathRef>(static_cast<uint64_t>(i) << shardShift);
+        shards.emplace_back(new PathShard(*this, base, indexMask + 1));
+    }
+
+    // Node 0 of shard 0 is the empty path every origin hangs off
+    PathShard& first = *shards[0];
+    first.chunks[0] = std::make_unique<PathShard::Node[]>(PathShard::CHUNK_SIZE);
+    first.chunks[0][0] = {0, EMPTY, 0};
+    first.count = 1;
+}
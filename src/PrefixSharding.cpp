@@ -0,0 +1,89 @@
+#include "ASGraph.h"
+#include "Policy.h"
+#include <algorithm>
+#include <thread>
+
+// Prefix-sharded propagation. Prefixes never interact, so disjoint prefix
+// ranges can run the whole up/across/down schedule independently. Each range
+// gets its own shard graph (topology copy plus shard-local RIBs) on its own
+// thread; paths go straight into this graph's store, in a block of shards
+// reserved per range, so merging is only a matter of appending RIBs.
+
+void ASGraph::propagateByPrefixShard() {
+    PrefixId prefixCount = static_cast<PrefixId>(prefixes.size());
+    unsigned shardCount = std::min<unsigned>(prefixShardCount, std::max<PrefixId>(prefixCount, 1));
+    std::vector<std::unique_ptr<ASGraph>> shards(shardCount);
+    std::vector<Profiler> shardProfilers(profiler ? shardCount : 0);
+
+    auto runShard = [&](unsigned s) {
+        PrefixId first = static_cast<PrefixId>(static_cast<uint64_t>(prefixCount) * s / shardCount);
+        PrefixId last = static_cast<PrefixId>(static_cast<uint64_t>(prefixCount) * (s + 1) / shardCount);
+        auto inRange = [](const Announcement& route, PrefixId id) { return route.prefixId < id; };
+
+        auto shard = std::make_unique<ASGraph>();
+        shard->engine = engine;
+        shard->setThreadCount(threadCount());
+        shard->copyTopology(*this);
+        shard->implicitRIB = implicitRIB;  // already marked for the whole prefix set
+        shard->sharedPaths = &paths;
+        shard->pathShardBase = s * threadCount();
+        if (profiler) shard->profiler = &shardProfilers[s];
+
+        // Same policies as ours, seeded with our routes for this range
+        for (uint32_t index = 0; index < nodes.size(); index++) {
+            std::unique_ptr<BGP> policy;
+            if (policyKinds[index] == PolicyKind::BGP) {
+                policy = std::make_unique<BGP>();
+            } else if (policyKinds[index] == PolicyKind::ROV) {
+                policy = std::make_unique<ROV>();
+            } else {
+                continue;
+            }
+            const RIB& routes = bgpPolicies[index]->localRIB;
+            auto begin = std::lower_bound(routes.begin(), routes.end(), first, inRange);
+            auto end = std::lower_bound(begin, routes.end(), last, inRange);
+            if (begin != end) {
+                policy->localRIB.insertSorted(std::vector<Announcement>(begin, end));
+            }
+            shard->nodes[index].policy = std::move(policy);
+        }
+        shard->classifyPolicies();
+        shard->propagateAnnouncements();
+        shards[s] = std::move(shard);
+    };
+
+    {
+        // Shards overlap in time, so only their combined counts are kept
+        ScopedPhase phase(profiler, "prefix_shards");
+        std::vector<std::thread> threads;
+        for (unsigned s = 1; s < shardCount; s++) {
+            threads.emplace_back(runShard, s);
+        }
+        runShard(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& shardProfiler : shardProfilers) {
+            profiler->counts(0) += shardProfiler.totals();
+        }
+    }
+
+    // Ranges ascend with the shard number, so appending each shard's RIB
+    // keeps ours sorted; the first shard's RIB is swapped in, not copied.
+    // Shards are freed as they are merged to bound memory.
+    ScopedPhase phase(profiler, "merge_shards");
+    for (unsigned s = 0; s < shardCount; s++) {
+        runWorkers([&](unsigned worker) {
+            for (uint32_t index = 0; index < nodes.size(); index++) {
+                if (!ownedBy(index, worker) || !bgpPolicies[index]) continue;
+                RIB& routes = shards[s]->bgpPolicies[index]->localRIB;
+                if (s == 0) {
+                    std::swap(bgpPolicies[index]->localRIB, routes);
+                } else {
+                    bgpPolicies[index]->localRIB.insertSorted(routes);
+                }
+            }
+        });
+        shards[s].reset();
+    }
+}
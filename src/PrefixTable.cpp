@@ -0,0 +1,27 @@
+#include "PrefixTable.h"
+
+PrefixId PrefixTable::intern(std::string_view prefix) {
+    auto it = ids.find(prefix);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    PrefixId id = static_cast<PrefixId>(prefixes.size());
+    prefixes.emplace_back(prefix);
+    ids.emplace(prefixes.back(), id);
+    return id;
+}
+
+bool PrefixTable::find(std::string_view prefix, PrefixId& id) const {
+    auto it = ids.find(prefix);
+    if (it == ids.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+void PrefixTable::clear() {
+    prefixes.clear();
+    ids.clear();
+}
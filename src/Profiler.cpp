@@ -0,0 +1,132 @@
+#include "Profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/resource.h>
+
+void Profiler::begin(const std::string& name) {
+    // Counts gathered so far belong to the enclosing phase
+    if (!open.empty()) {
+        for (auto& worker : workerCounts) {
+            phases[open.back()].counts += worker.counts;
+            worker.counts = RouteCounts();
+        }
+    }
+    phases.push_back({name, static_cast<int>(open.size()), 0.0, RouteCounts(), 0});
+    open.push_back(phases.size() - 1);
+    started.push_back(std::chrono::steady_clock::now());
+}
+
+void Profiler::end() {
+    if (open.empty()) return;
+    Phase& phase = phases[open.back()];
+    phase.milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started.back()).count();
+    for (auto& worker : workerCounts) {
+        phase.counts += worker.counts;
+        worker.counts = RouteCounts();
+    }
+    open.pop_back();
+    started.pop_back();
+}
+
+void Profiler::setWorkers(unsigned workers) {
+    if (workers > workerCounts.size()) {
+        workerCounts.resize(workers);
+    }
+}
+
+RouteCounts Profiler::totals() const {
+    RouteCounts total;
+    for (const auto& phase : phases) {
+        total += phase.counts;
+    }
+    return total;
+}
+
+size_t Profiler::peakRSSKilobytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(usage.ru_maxrss);  // kilobytes on Linux
+}
+
+void Profiler::printSummary() const {
+    std::cout << "Profile:" << std::endl;
+    for (const auto& phase : phases) {
+        std::cout << "  " << std::string(phase.depth * 2, ' ') << std::left << std::setw(28 - phase.depth * 2)
+                  << phase.name << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+                  << phase.milliseconds << " ms";
+        if (phase.counts.sent > 0) {
+            std::cout << "  sent " << phase.counts.sent << ", rov-dropped " << phase.counts.droppedByROV
+                      << ", accepted " << phase.counts.accepted << ", replaced " << phase.counts.replaced
+                      << ", rejected " << phase.counts.rejected;
+        }
+        if (phase.edges > 0) {
+            std::cout << "  over " << phase.edges << " peer edges";
+        }
+        std::cout << std::endl;
+    }
+    RouteCounts total = totals();
+    std::cout << "  Total routes sent " << total.sent << ", rov-dropped " << total.droppedByROV
+              << ", accepted " << total.accepted << ", replaced " << total.replaced
+              << ", rejected " << total.rejected << std::endl;
+    std::cout << "  Peak RSS: " << peakRSSKilobytes() << " KB" << std::endl;
+}
+
+namespace {
+
+void writeCounts(std::ofstream& file, const RouteCounts& counts) {
+    file << "\"sent\": " << counts.sent << ", \"dropped_by_rov\": " << counts.droppedByROV
+         << ", \"accepted\": " << counts.accepted << ", \"replaced\": " << counts.replaced
+         << ", \"rejected\": " << counts.rejected;
+}
+
+// Phase names are generated by the simulator, but escape them anyway
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+bool Profiler::writeJSON(const std::string& filename, const std::string& engine, unsigned threads) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening profile file: " << filename << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n";
+    file << "  \"engine\": " << jsonString(engine) << ",\n";
+    file << "  \"threads\": " << threads << ",\n";
+    file << "  \"peak_rss_kb\": " << peakRSSKilobytes() << ",\n";
+    file << "  \"phases\": [\n";
+    for (size_t i = 0; i < phases.size(); i++) {
+        const Phase& phase = phases[i];
+        file << "    {\"name\": " << jsonString(phase.name) << ", \"depth\": " << phase.depth
+             << ", \"ms\": " << phase.milliseconds << ", ";
+        writeCounts(file, phase.counts);
+        if (phase.edges > 0) {
+            file << ", \"edges\": " << phase.edges;
+        }
+        file << "}" << (i + 1 < phases.size() ? "," : "") << "\n";
+    }
+    file << "  ],\n";
+    file << "  \"totals\": {";
+    writeCounts(file, totals());
+    file << "}\n";
+    file << "}\n";
+
+    if (!file.good()) {
+        std::cerr << "Error writing profile file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+#include "ASGraph.h"
+#include "RouteKernels.h"
+
+// Receiver-driven propagation. Ranks guarantee that every sender a receiver
+// pulls from is already final, so each receiver can scan its neighbors' RIBs
+// and keep the best route in place. Nothing is queued or copied per hop, and
+// since a receiver only writes its own RIB, workers need no locks.
+
+namespace {
+
+// Receivers with more than one sender pick each prefix's winner over all
+// senders first (CandidateTable). Merging one RIB at a time would prepend a
+// path for every route that leads until a later sender beats it, which is
+// most of the cost for multi-homed ASes; a single sender merges directly.
+const size_t CANDIDATE_TABLE_MIN_SENDERS = 2;
+
+} // namespace
+
+template <PolicyKind Kind>
+RouteCounts ASGraph::pullInto(RIB& target, uint32_t receiver, NeighborRange senders, Relationship relationship,
+                              PathShard& shard, bool prependOwner) {
+    static_assert(Kind == PolicyKind::BGP || Kind == PolicyKind::ROV, "custom policies use offerToCustom");
+    RouteCounts counts;
+    int receiverASN = nodes[receiver].asn;
+
+    if (senders.size() >= CANDIDATE_TABLE_MIN_SENDERS) {
+        CandidateTable& table = CandidateTable::local();
+        for (uint32_t sender : senders) {
+            const BGP* senderBGP = bgpPolicies[sender];
+            if (!senderBGP) continue;
+            counts += offerRoutes<Kind == PolicyKind::ROV>(table, senderBGP->localRIB, nodes[sender].asn,
+                                                           relationship, receiverASN);
+        }
+        counts += commitCandidates(table, target, receiverASN, shard, prependOwner);
+        return counts;
+    }
+
+    for (uint32_t sender : senders) {
+        const BGP* senderBGP = bgpPolicies[sender];
+        if (!senderBGP) continue;
+        counts += receiveRoutes<Kind == PolicyKind::ROV>(target, senderBGP->localRIB, nodes[sender].asn,
+                                                         relationship, receiverASN, shard, prependOwner);
+    }
+    return counts;
+}
+
+// Queues every sender's routes on the receiver; the caller runs
+// processAnnouncements once nothing reads the receiver's RIB any more
+RouteCounts ASGraph::offerToCustom(uint32_t receiver, NeighborRange senders, Relationship relationship) {
+    RouteCounts counts;
+    for (uint32_t sender : senders) {
+        if (bgpPolicies[sender]) counts += offerToPolicy(sender, receiver, relationship);
+    }
+    return counts;
+}
+
+template <PolicyKind Kind>
+void ASGraph::pullGroup(const std::vector<uint32_t>& receivers, NeighborFn sendersOf,
+                        Relationship relationship, unsigned worker) {
+    PathShard& shard = pathShard(worker);
+    RouteCounts counts;
+    for (uint32_t receiver : receivers) {
+        if (!ownedBy(receiver, worker)) continue;
+        if constexpr (Kind == PolicyKind::CUSTOM) {
+            counts += offerToCustom(receiver, (topology.*sendersOf)(receiver), relationship);
+            bgpPolicies[receiver]->processAnnouncements(nodes[receiver].asn, shard);
+        } else {
+            counts += pullInto<Kind>(bgpPolicies[receiver]->localRIB, receiver, (topology.*sendersOf)(receiver),
+                                     relationship, shard, !defersOwnerHop(receiver));
+        }
+    }
+    if (profiler) profiler->counts(worker) += counts;
+}
+
+void ASGraph::pullFromNeighbors(const PolicyGroups& receivers, NeighborFn sendersOf,
+                                Relationship relationship, unsigned worker) {
+    pullGroup<PolicyKind::BGP>(receivers.bgp, sendersOf, relationship, worker);
+    pullGroup<PolicyKind::ROV>(receivers.rov, sendersOf, relationship, worker);
+    pullGroup<PolicyKind::CUSTOM>(receivers.custom, sendersOf, relationship, worker);
+}
+
+void ASGraph::pullUpward() {
+    // Customers sit in lower ranks, so they are final before we reach a rank
+    for (size_t rank = 0; rank < rankGroups.size(); rank++) {
+        ScopedPhase phase(profiler, profiler ? "up.rank" + std::to_string(rank) : std::string());
+        runWorkers([&](unsigned worker) {
+            pullFromNeighbors(rankGroups[rank], &Topology::customers, Relationship::CUSTOMER, worker);
+        });
+    }
+}
+
+void ASGraph::pullAcross() {
+    // Peer routes travel exactly one hop, so everyone reads the pre-exchange
+    // RIBs of their peers into a staging table before anything is committed
+    ScopedPhase phase(profiler, "across");
+    ReceiverEdges edges = collectPeerEdges();
+    if (profiler) profiler->addEdges(edges.senders.size());
+    std::vector<RIB> staged(edges.receivers.size());
+
+    runWorkers([&](unsigned worker) {
+        PathShard& shard = pathShard(worker);
+        RouteCounts counts;
+        for (size_t slot = edges.workerSlices[worker]; slot < edges.workerSlices[worker + 1]; slot++) {
+            uint32_t receiver = edges.receivers[slot];
+            NeighborRange senders = edges.sendersOf(slot);
+            switch (policyKinds[receiver]) {
+            case PolicyKind::BGP:
+                counts += pullInto<PolicyKind::BGP>(staged[slot], receiver, senders, Relationship::PEER, shard);
+                break;
+            case PolicyKind::ROV:
+                counts += pullInto<PolicyKind::ROV>(staged[slot], receiver, senders, Relationship::PEER, shard);
+                break;
+            case PolicyKind::CUSTOM:
+                // Queued now, processed with the commits below
+                counts += offerToCustom(receiver, senders, Relationship::PEER);
+                break;
+            case PolicyKind::NONE:
+                break;
+            }
+        }
+        if (profiler) {
+            // A staged route that loses, or is displaced, never reaches the
+            // RIB; the survivors are counted when they are committed
+            counts.rejected += counts.replaced;
+            counts.replaced = 0;
+            counts.accepted = 0;
+            profiler->counts(worker) += counts;
+        }
+    });
+
+    runWorkers([&](unsigned worker) {
+        PathShard& shard = pathShard(worker);
+        for (size_t slot = edges.workerSlices[worker]; slot < edges.workerSlices[worker + 1]; slot++) {
+            uint32_t receiver = edges.receivers[slot];
+            if (policyKinds[receiver] == PolicyKind::CUSTOM) {
+                bgpPolicies[receiver]->processAnnouncements(nodes[receiver].asn, shard);
+                continue;
+            }
+            if (staged[slot].empty()) continue;
+            RouteCounts counts = bgpPolicies[receiver]->localRIB.mergeBest(staged[slot]);
+            if (profiler) profiler->counts(worker) += counts;
+        }
+    });
+}
+
+void ASGraph::pullDownward() {
+    if (!spillFilename.empty()) planSpill();
+
+    // Providers sit in higher ranks, so walk the ranks from the top down
+    for (size_t rank = rankGroups.size(); rank-- > 0;) {
+        ScopedPhase phase(profiler, profiler ? "down.rank" + std::to_string(rank) : std::string());
+        if (spillFilename.empty()) {
+            runWorkers([&](unsigned worker) {
+                pullFromNeighbors(rankGroups[rank], &Topology::providers, Relationship::PROVIDER, worker);
+            });
+            continue;
+        }
+        for (const SpillWindow& window : spillWindows[rank]) {
+            runWorkers([&](unsigned worker) {
+                pullFromNeighbors(window.receivers, &Topology::providers, Relationship::PROVIDER, worker);
+            });
+            releaseNodes(window.released);
+        }
+    }
+}
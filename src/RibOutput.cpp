@@ -0,0 +1,272 @@
+#include "ASGraph.h"
+#include "RibFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// Nodes each worker formats per round; bounds memory to a few MB per worker
+const uint32_t OUTPUT_BATCH_NODES = 2048;
+
+} // namespace
+
+bool ASGraph::appendRibRows(uint32_t index, std::string& out, std::vector<int>& hops) const {
+    if (spill && spill->holds(index)) {
+        return spill->read(index, out);
+    }
+    const BGP* bgp = dynamic_cast<const BGP*>(nodes[index].policy.get());
+    if (!bgp) return true;
+
+    if (hasImplicitRIB(index)) {
+        appendRows(index, providerRIB(index), RowPaths::INHERITED, out, hops);
+    } else {
+        appendRows(index, bgp->localRIB, defersOwnerHop(index) ? RowPaths::OWNER_DEFERRED : RowPaths::OWN, out,
+                   hops);
+    }
+    return true;
+}
+
+// Formats one node's rows from rib. Unless the paths are the node's own,
+// the node is prepended to each; an implicit stub also skips the provider
+// routes it would not have taken, and its pathLength excludes the stub.
+void ASGraph::appendRows(uint32_t index, const RIB& rib, RowPaths source, std::string& out,
+                         std::vector<int>& hops) const {
+    if (rib.empty()) return;
+    bool inherited = source == RowPaths::INHERITED;
+    auto rowOf = [&](const Announcement& announcement) { return !inherited || inheritsRoute(index, announcement); };
+    uint32_t extraHops = inherited ? 1 : 0;
+    uint32_t ownerHops = source == RowPaths::OWN ? 0 : 1;
+    int asn = nodes[index].asn;
+
+    // Collect every entry's path in lockstep: the walks are independent, so
+    // their cache misses overlap instead of being paid one after another
+    size_t totalHops = 0;
+    for (const auto& announcement : rib) {
+        if (rowOf(announcement)) totalHops += announcement.pathLength + extraHops;
+    }
+    hops.resize(totalHops);
+
+    std::vector<PathRef> cursors;
+    std::vector<size_t> positions;
+    cursors.reserve(rib.size());
+    positions.reserve(rib.size());
+    size_t position = 0;
+    for (const auto& announcement : rib) {
+        if (!rowOf(announcement)) continue;
+        if (ownerHops) hops[position] = asn;
+        cursors.push_back(announcement.asPath);
+        positions.push_back(position + ownerHops);
+        position += announcement.pathLength + extraHops;
+    }
+    size_t entryCount = cursors.size();
+
+    for (bool active = true; active;) {
+        active = false;
+        for (size_t i = 0; i < entryCount; i++) {
+            if (cursors[i] == PathStore::EMPTY) continue;
+            hops[positions[i]++] = paths.head(cursors[i]);
+            cursors[i] = paths.parent(cursors[i]);
+            active = true;
+        }
+    }
+
+    position = 0;
+    for (const auto& announcement : rib) {
+        if (!rowOf(announcement)) continue;
+        const std::string& prefix = prefixes.toString(announcement.prefixId);
+        uint32_t pathLength = announcement.pathLength + extraHops;
+
+        // Size the row up front and format straight into the buffer
+        size_t used = out.size();
+        out.resize(used + maxRibRowSize(prefix.size(), pathLength));
+        char* end = formatRibRow(&out[used], asn, prefix.data(), prefix.size(), hops.data() + position, pathLength);
+        out.resize(end - out.data());
+        position += pathLength;
+    }
+}
+
+bool ASGraph::outputToCSV(const std::string& filename) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening output file: " << filename << std::endl;
+        return false;
+    }
+    if (spill && !spill->finishWriting()) {
+        return false;
+    }
+    file << RIB_CSV_HEADER;
+
+    // Each round, every worker formats its own consecutive batch of nodes;
+    // the buffers are then written in worker order, which keeps the file in
+    // node order no matter how many threads format it
+    unsigned workers = threadCount();
+    std::vector<std::string> buffers(workers);
+    std::vector<std::vector<int>> hopScratch(workers);
+    std::vector<char> spillFailed(workers, 0);
+    uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+
+    for (uint32_t roundStart = 0; roundStart < nodeCount; roundStart += OUTPUT_BATCH_NODES * workers) {
+        runWorkers([&](unsigned worker) {
+            std::string& out = buffers[worker];
+            out.clear();
+            uint32_t first = std::min(nodeCount, roundStart + worker * OUTPUT_BATCH_NODES);
+            uint32_t last = std::min(nodeCount, first + OUTPUT_BATCH_NODES);
+            for (uint32_t index = first; index < last; index++) {
+                if (!appendRibRows(index, out, hopScratch[worker])) spillFailed[worker] = 1;
+            }
+        });
+        if (std::find(spillFailed.begin(), spillFailed.end(), 1) != spillFailed.end()) {
+            return false;
+        }
+
+        for (const auto& out : buffers) {
+            file.write(out.data(), out.size());
+        }
+    }
+
+    file.close();
+    if (file.fail()) {
+        std::cerr << "Error writing output file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Streams one fixed-width column through a reusable buffer
+template <typename T>
+class ColumnWriter {
+public:
+    explicit ColumnWriter(std::ofstream& file) : file(file) { buffer.reserve(COLUMN_BUFFER_VALUES); }
+    ~ColumnWriter() { flush(); }
+
+    void push(T value) {
+        buffer.push_back(value);
+        if (buffer.size() == COLUMN_BUFFER_VALUES) flush();
+    }
+
+    void flush() {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(T));
+        buffer.clear();
+    }
+
+private:
+    static const size_t COLUMN_BUFFER_VALUES = 1 << 18;
+
+    std::ofstream& file;
+    std::vector<T> buffer;
+};
+
+} // namespace
+
+bool ASGraph::outputToBinary(const std::string& filename) const {
+    if (!spillFilename.empty()) {
+        std::cerr << "Binary output is not available for memory-budgeted runs" << std::endl;
+        return false;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening output file: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<const BGP*> ribs(nodes.size(), nullptr);
+    for (size_t index = 0; index < nodes.size(); index++) {
+        ribs[index] = dynamic_cast<const BGP*>(nodes[index].policy.get());
+    }
+
+    // Visits every row in file order as (node, route, inherited). An
+    // implicit stub's rows are its provider's routes; their paths are not in
+    // the store, so each gets its own entry after the store's paths
+    auto forEachRow = [&](auto&& visit) {
+        for (uint32_t index = 0; index < nodes.size(); index++) {
+            if (!ribs[index]) continue;
+            if (hasImplicitRIB(index)) {
+                for (const auto& route : providerRIB(index)) {
+                    if (inheritsRoute(index, route)) visit(index, route, true);
+                }
+            } else {
+                for (const auto& route : ribs[index]->localRIB) visit(index, route, false);
+            }
+        }
+    };
+    uint64_t rowCount = 0;
+    uint64_t inheritedRows = 0;
+    forEachRow([&](uint32_t, const Announcement&, bool inherited) {
+        rowCount++;
+        if (inherited) inheritedRows++;
+    });
+
+    std::vector<uint32_t> stringOffsets;
+    stringOffsets.reserve(prefixes.size() + 1);
+    stringOffsets.push_back(0);
+    for (PrefixId id = 0; id < prefixes.size(); id++) {
+        stringOffsets.push_back(stringOffsets.back() + static_cast<uint32_t>(prefixes.toString(id).size()));
+    }
+
+    RibFileHeader header = {};
+    std::memcpy(header.magic, RIB_FILE_MAGIC, sizeof(header.magic));
+    header.version = RIB_FILE_VERSION;
+    header.prefixCount = static_cast<uint32_t>(prefixes.size());
+    header.rowCount = rowCount;
+    header.pathCount = paths.size() + inheritedRows;
+    header.stringBytes = stringOffsets.back();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Paths are written as the hash-consed tree itself: every distinct path
+    // appears once, numbered densely across the store's shards
+    std::vector<uint32_t> denseOffsets = paths.denseOffsets();
+
+    {
+        ColumnWriter<int32_t> column(file);
+        forEachRow([&](uint32_t index, const Announcement&, bool) { column.push(nodes[index].asn); });
+    }
+    {
+        ColumnWriter<uint32_t> column(file);
+        forEachRow([&](uint32_t, const Announcement& route, bool) { column.push(route.prefixId); });
+    }
+    {
+        ColumnWriter<uint32_t> column(file);
+        uint32_t nextInherited = static_cast<uint32_t>(paths.size());
+        forEachRow([&](uint32_t, const Announcement& route, bool inherited) {
+            column.push(inherited ? nextInherited++ : paths.denseIndex(route.asPath, denseOffsets));
+        });
+    }
+    {
+        ColumnWriter<int32_t> column(file);
+        for (unsigned shard = 0; shard < paths.shardCount(); shard++) {
+            for (uint32_t i = 0; i < paths.shardSize(shard); i++) {
+                column.push(paths.head(paths.nodeRef(shard, i)));
+            }
+        }
+        forEachRow([&](uint32_t index, const Announcement&, bool inherited) {
+            if (inherited) column.push(nodes[index].asn);
+        });
+    }
+    {
+        ColumnWriter<uint32_t> column(file);
+        for (unsigned shard = 0; shard < paths.shardCount(); shard++) {
+            for (uint32_t i = 0; i < paths.shardSize(shard); i++) {
+                column.push(paths.denseIndex(paths.parent(paths.nodeRef(shard, i)), denseOffsets));
+            }
+        }
+        forEachRow([&](uint32_t, const Announcement& route, bool inherited) {
+            if (inherited) column.push(paths.denseIndex(route.asPath, denseOffsets));
+        });
+    }
+
+    file.write(reinterpret_cast<const char*>(stringOffsets.data()), stringOffsets.size() * sizeof(uint32_t));
+    for (PrefixId id = 0; id < prefixes.size(); id++) {
+        const std::string& prefix = prefixes.toString(id);
+        file.write(prefix.data(), prefix.size());
+    }
+
+    if (!file.good()) {
+        std::cerr << "Error writing output file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,249 @@
+#include "RibSpill.h"
+#include "ASGraph.h"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+RibSpill::~RibSpill() {
+    if (writer.is_open()) writer.close();
+    if (fd >= 0) ::close(fd);
+    if (!filename.empty()) std::remove(filename.c_str());
+}
+
+bool RibSpill::open(const std::string& filename, size_t nodeCount) {
+    writer.open(filename, std::ios::binary | std::ios::trunc);
+    if (!writer.is_open()) {
+        std::cerr << "Error opening spill file: " << filename << std::endl;
+        return false;
+    }
+    this->filename = filename;
+    extents.assign(nodeCount, Extent());
+    return true;
+}
+
+bool RibSpill::append(uint32_t index, const char* data, size_t size, uint32_t rowCount) {
+    if (failed) return false;
+    Extent& extent = extents[index];
+    extent.offset = bytes;
+    extent.size = size;
+    extent.rowCount = rowCount;
+
+    writer.write(data, size);
+    bytes += size;
+    if (!writer.good()) {
+        std::cerr << "Error writing spill file: " << filename << std::endl;
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool RibSpill::commit(const std::vector<uint32_t>& indices) {
+    if (!failed && !writer.flush().good()) {
+        std::cerr << "Error writing spill file: " << filename << std::endl;
+        failed = true;
+    }
+    if (failed) return false;
+    for (uint32_t index : indices) {
+        extents[index].spilled = true;
+        rows += extents[index].rowCount;
+    }
+    return true;
+}
+
+bool RibSpill::finishWriting() {
+    if (fd >= 0) return true;
+
+    // Every committed row was flushed already; a failed write only left
+    // rows behind that are still held in memory
+    writer.clear();
+    writer.close();
+    if (writer.fail() && !failed) {
+        std::cerr << "Error writing spill file: " << filename << std::endl;
+        return false;
+    }
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error reopening spill file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RibSpill::read(uint32_t index, std::string& out) const {
+    // pread keeps no file position, so workers can share the descriptor
+    const Extent& extent = extents[index];
+    size_t used = out.size();
+    out.resize(used + extent.size);
+    uint64_t done = 0;
+    while (done < extent.size) {
+        ssize_t got = pread(fd, &out[used + done], extent.size - done, static_cast<off_t>(extent.offset + done));
+        if (got <= 0) {
+            std::cerr << "Error reading spill file: " << filename << std::endl;
+            out.resize(used);
+            return false;
+        }
+        done += static_cast<uint64_t>(got);
+    }
+    return true;
+}
+
+// Memory-budgeted runs. In the downward pass a finished RIB is read only by
+// customers that have not run yet and, at output, by the node's implicit
+// stubs. Once those customers are done, the node's rows (and its stubs')
+// can be written out early and the RIB freed. Leaves, which nobody reads,
+// are done as soon as they are final, so pull runs the wide bottom ranks in
+// windows and frees their leaves as it goes. Their paths are not even
+// extended: the leaf's ASN is added when the rows are formatted.
+
+namespace {
+
+// Nodes each worker formats per round, as in RibOutput.cpp
+const uint32_t SPILL_BATCH_NODES = 2048;
+
+// Receivers per pull window
+const size_t SPILL_WINDOW_NODES = 8192;
+
+} // namespace
+
+void ASGraph::setMemoryBudget(size_t budgetBytes, const std::string& spillFile) {
+    memoryBudget = budgetBytes;
+    spillFilename = spillFile;
+}
+
+uint64_t ASGraph::spilledRoutes() const {
+    return spill ? spill->totalRows() : 0;
+}
+
+void ASGraph::planSpill() {
+    size_t rankCount = propagationRanks.size();
+    spillWindows.assign(rankCount, std::vector<SpillWindow>(1));
+    spillPending.clear();
+    ownerHopDeferred.assign(nodes.size(), 0);
+
+    // Nodes done only once a later step ends, added to that step's last window
+    std::vector<std::vector<uint32_t>> doneAfter(rankCount);
+    auto addWithStubs = [&](std::vector<uint32_t>& list, uint32_t index) {
+        list.push_back(index);
+        for (uint32_t customer : topology.customers(index)) {
+            if (hasImplicitRIB(customer)) list.push_back(customer);
+        }
+    };
+    auto receives = [&](uint32_t index) { return bgpPolicies[index] && !hasImplicitRIB(index); };
+
+    for (size_t rank = 0; rank < rankCount; rank++) {
+        size_t windowSize = 0;
+        for (uint32_t index : propagationRanks[rank]) {
+            if (!receives(index)) continue;
+
+            // The lowest rank among the customers that read this RIB
+            size_t lastReader = rankCount;
+            for (uint32_t customer : topology.customers(index)) {
+                if (receives(customer)) {
+                    lastReader = std::min(lastReader, static_cast<size_t>(nodes[customer].propagationRank));
+                }
+            }
+
+            if (windowSize == SPILL_WINDOW_NODES) {
+                spillWindows[rank].emplace_back();
+                windowSize = 0;
+            }
+            SpillWindow& window = spillWindows[rank].back();
+            addToGroup(window.receivers, policyKinds[index], index);
+            windowSize++;
+            if (lastReader == rankCount) {
+                // Nobody reads this leaf's paths before its rows are written,
+                // unless it already has routes or an implicit stub inherits them
+                const auto& stubs = topology.customers(index);
+                bool feedsStub = std::any_of(stubs.begin(), stubs.end(),
+                                             [&](uint32_t customer) { return hasImplicitRIB(customer); });
+                if (policyKinds[index] != PolicyKind::CUSTOM && bgpPolicies[index]->localRIB.empty() && !feedsStub) {
+                    ownerHopDeferred[index] = 1;
+                }
+                addWithStubs(window.released, index);
+            } else {
+                addWithStubs(doneAfter[lastReader], index);
+            }
+        }
+    }
+
+    for (size_t rank = 0; rank < rankCount; rank++) {
+        std::vector<uint32_t>& released = spillWindows[rank].back().released;
+        released.insert(released.end(), doneAfter[rank].begin(), doneAfter[rank].end());
+    }
+}
+
+void ASGraph::releaseNodes(const std::vector<uint32_t>& indices) {
+    if (spillFailed) return;
+    spillPending.insert(spillPending.end(), indices.begin(), indices.end());
+    if (spillPending.empty()) return;
+
+    size_t held = 0;
+    for (const BGP* bgp : bgpPolicies) {
+        if (bgp) held += bgp->localRIB.memoryBytes();
+    }
+    if (held <= memoryBudget) return;
+
+    spillNodes(spillPending);
+    spillPending.clear();
+}
+
+void ASGraph::spillNodes(const std::vector<uint32_t>& indices) {
+    ScopedPhase phase(profiler, "spill");
+    if (!spill) {
+        spill = std::make_unique<RibSpill>();
+        if (!spill->open(spillFilename, nodes.size())) {
+            // Keep everything in memory rather than lose routes
+            spill.reset();
+            spillFailed = true;
+            return;
+        }
+    }
+
+    // Workers format consecutive batches; the rows are appended in list
+    // order, and every RIB is freed only once all of them are formatted,
+    // since an implicit stub's rows come from its provider's RIB
+    unsigned workers = threadCount();
+    std::vector<std::string> buffers(workers);
+    std::vector<std::vector<size_t>> ends(workers);
+    std::vector<std::vector<int>> hopScratch(workers);
+    size_t count = indices.size();
+
+    for (size_t roundStart = 0; roundStart < count; roundStart += SPILL_BATCH_NODES * workers) {
+        runWorkers([&](unsigned worker) {
+            buffers[worker].clear();
+            ends[worker].clear();
+            size_t first = std::min(count, roundStart + worker * SPILL_BATCH_NODES);
+            size_t last = std::min(count, first + SPILL_BATCH_NODES);
+            for (size_t i = first; i < last; i++) {
+                appendRibRows(indices[i], buffers[worker], hopScratch[worker]);
+                ends[worker].push_back(buffers[worker].size());
+            }
+        });
+
+        for (unsigned worker = 0; worker < workers; worker++) {
+            size_t first = std::min(count, roundStart + worker * SPILL_BATCH_NODES);
+            size_t begin = 0;
+            for (size_t i = 0; i < ends[worker].size(); i++) {
+                uint32_t index = indices[first + i];
+                if (!spill->append(index, buffers[worker].data() + begin, ends[worker][i] - begin,
+                                   static_cast<uint32_t>(rowCount(index)))) {
+                    break;
+                }
+                begin = ends[worker][i];
+            }
+        }
+    }
+
+    // Nothing is freed unless all of its rows are on disk
+    if (!spill->commit(indices)) {
+        std::cerr << "Keeping the remaining RIBs in memory" << std::endl;
+        spillFailed = true;
+        return;
+    }
+    for (uint32_t index : indices) {
+        if (!hasImplicitRIB(index)) bgpPolicies[index]->localRIB.release();
+    }
+}
@@ -0,0 +1,297 @@
+#include "ASGraph.h"
+#include "Policy.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
+
+namespace {
+
+// Up to this many affected prefixes, converged RIBs are patched by binary
+// search instead of being rewritten in full
+const size_t POINT_UPDATE_PREFIXES = 8;
+
+// Re-propagation is scoped to the reachable region only while it covers at
+// most 1/REGION_MAX_SHARE of the graph; past that, walking the whole graph
+// is as cheap as tracking the region
+const size_t REGION_MAX_SHARE = 2;
+
+} // namespace
+
+bool RouteDelta::loadFromCSV(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening delta file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    bool firstLine = true;
+    size_t lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (firstLine) {
+            firstLine = false;
+            continue; // Skip header
+        }
+        if (line.empty()) continue;
+
+        std::istringstream iss(line);
+        std::string action, asnStr, prefix, rovInvalidStr;
+        std::getline(iss, action, ',');
+        std::getline(iss, asnStr, ',');
+        std::getline(iss, prefix, ',');
+        std::getline(iss, rovInvalidStr);
+
+        int asn = 0;
+        try {
+            asn = std::stoi(asnStr);
+        } catch (const std::exception&) {
+            std::cerr << "Bad ASN on line " << lineNumber << " of " << filename << std::endl;
+            return false;
+        }
+        bool rovInvalid = rovInvalidStr == "true" || rovInvalidStr == "True" || rovInvalidStr == "1";
+
+        if (action == "rov_on") {
+            enableROV.push_back(asn);
+        } else if (action == "rov_off") {
+            disableROV.push_back(asn);
+        } else if ((action == "announce" || action == "withdraw") && !prefix.empty()) {
+            (action == "announce" ? announced : withdrawn).push_back({asn, prefix, rovInvalid});
+        } else {
+            std::cerr << "Bad delta action on line " << lineNumber << " of " << filename
+                      << " (expected announce,withdraw,rov_on or rov_off)" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ASGraph::applyDelta(const RouteDelta& delta) {
+    if (!spillFilename.empty()) {
+        std::cerr << "Deltas cannot be applied to a memory-budgeted run" << std::endl;
+        return false;
+    }
+    std::vector<char> affected(prefixes.size(), 0);
+    std::vector<uint32_t> origins;  // withdrawn seeds' ASes; the remaining ones are added below
+    bool anyAffected = false;
+    bool allApplied = true;
+    auto markAffected = [&](PrefixId prefixId) {
+        if (prefixId >= affected.size()) affected.resize(prefixId + 1, 0);
+        affected[prefixId] = 1;
+        anyAffected = true;
+    };
+
+    // Policy flips: ROV and BGP only disagree on invalid routes, so the only
+    // prefixes a flip can change are those with an invalid seed somewhere.
+    // The AS keeps its converged RIB; stale routes are dropped below.
+    bool flipped = false;
+    auto flip = [&](int asn, bool toROV) {
+        ASNode* node = findNode(asn);
+        Policy* policy = node ? node->policy.get() : nullptr;
+        const std::type_info& from = toROV ? typeid(BGP) : typeid(ROV);
+        if (!policy || typeid(*policy) != from) {
+            std::cerr << "Skipping ROV change for AS " << asn << ": not a plain "
+                      << (toROV ? "BGP" : "ROV") << " AS" << std::endl;
+            allApplied = false;
+            return;
+        }
+        std::unique_ptr<BGP> replacement;
+        if (toROV) {
+            replacement = std::make_unique<ROV>();
+        } else {
+            replacement = std::make_unique<BGP>();
+        }
+        replacement->localRIB = std::move(static_cast<BGP*>(policy)->localRIB);
+        node->policy = std::move(replacement);
+        flipped = true;
+    };
+    for (int asn : delta.enableROV) flip(asn, true);
+    for (int asn : delta.disableROV) flip(asn, false);
+    if (flipped) {
+        classifyPolicies();
+        for (const auto& seed : seeds) {
+            if (seed.rovInvalid) markAffected(seed.prefixId);
+        }
+    }
+
+    for (const auto& change : delta.withdrawn) {
+        int index = topology.indexOf(change.asn);
+        PrefixId prefixId;
+        if (index < 0 || !prefixes.find(change.prefix, prefixId)) {
+            std::cerr << "Skipping withdrawal of " << change.prefix << " from AS " << change.asn
+                      << ": never announced" << std::endl;
+            allApplied = false;
+            continue;
+        }
+        size_t before = seeds.size();
+        seeds.erase(std::remove_if(seeds.begin(), seeds.end(), [&](const Seed& seed) {
+                        return seed.index == static_cast<uint32_t>(index) && seed.prefixId == prefixId;
+                    }),
+                    seeds.end());
+        if (seeds.size() == before) {
+            std::cerr << "Skipping withdrawal of " << change.prefix << " from AS " << change.asn
+                      << ": that AS does not announce it" << std::endl;
+            allApplied = false;
+            continue;
+        }
+        markAffected(prefixId);
+        origins.push_back(static_cast<uint32_t>(index));
+    }
+
+    for (const auto& change : delta.announced) {
+        int index = topology.indexOf(change.asn);
+        if (index < 0 || !dynamic_cast<BGP*>(nodes[index].policy.get())) {
+            std::cerr << "Skipping announcement of " << change.prefix << " from AS " << change.asn
+                      << ": not a BGP AS in the graph" << std::endl;
+            allApplied = false;
+            continue;
+        }
+        // A seeded stub announces to its provider, so it needs a real RIB
+        if (hasImplicitRIB(index)) {
+            materializeImplicitRIB(index, pathShard(0));
+        }
+        PrefixId prefixId = prefixes.intern(change.prefix);
+        seeds.push_back({static_cast<uint32_t>(index), prefixId, change.rovInvalid});
+        markAffected(prefixId);
+    }
+
+    if (!anyAffected) {
+        return allApplied;
+    }
+    affected.resize(prefixes.size(), 0);
+    std::vector<PrefixId> affectedIds;
+    for (PrefixId prefixId = 0; prefixId < affected.size(); prefixId++) {
+        if (affected[prefixId]) affectedIds.push_back(prefixId);
+    }
+
+    // Old and new routes for the affected prefixes can only sit where a
+    // valley-free path from one of their origins leads, so only that region
+    // re-propagates. Its neighbors are set aside too, so anything the region
+    // reads from outside it looks empty. An origin below a well-connected
+    // provider reaches most of an Internet-scale graph, though, and then
+    // the whole graph runs.
+    for (const auto& seed : seeds) {
+        if (affected[seed.prefixId]) origins.push_back(seed.index);
+    }
+    // Only ASes holding routes need to be set aside; the swap is O(1) each
+    auto holdsRoutes = [&](uint32_t index) {
+        const BGP* bgp = dynamic_cast<const BGP*>(nodes[index].policy.get());
+        return bgp && !bgp->localRIB.empty();
+    };
+    std::vector<uint32_t> setAside;
+    scopedToRegion = valleyFreeReach(origins, nodes.size() / REGION_MAX_SHARE, regionNodes);
+    if (scopedToRegion) {
+        regionRanks.assign(propagationRanks.size(), {});
+        std::vector<uint8_t> touched(nodes.size(), 0);
+        for (uint32_t index : regionNodes) {
+            regionRanks[nodes[index].propagationRank].push_back(index);
+            for (NeighborRange neighbors : {topology.providers(index), topology.customers(index), topology.peers(index)}) {
+                for (uint32_t neighbor : neighbors) {
+                    if (!touched[neighbor]) {
+                        touched[neighbor] = 1;
+                        setAside.push_back(neighbor);
+                    }
+                }
+            }
+            if (!touched[index]) {
+                touched[index] = 1;
+                setAside.push_back(index);
+            }
+        }
+        setAside.erase(std::remove_if(setAside.begin(), setAside.end(),
+                                      [&](uint32_t index) { return !holdsRoutes(index); }),
+                       setAside.end());
+        std::sort(setAside.begin(), setAside.end());
+    } else {
+        for (uint32_t index = 0; index < nodes.size(); index++) {
+            if (holdsRoutes(index)) setAside.push_back(index);
+        }
+    }
+
+    // Propagate the affected prefixes over otherwise empty RIBs: routes for
+    // other prefixes are never touched
+    std::vector<RIB> converged(setAside.size());
+    for (size_t i = 0; i < setAside.size(); i++) {
+        BGP* bgp = dynamic_cast<BGP*>(nodes[setAside[i]].policy.get());
+        if (bgp) std::swap(converged[i], bgp->localRIB);
+    }
+
+    for (const auto& seed : seeds) {
+        if (!affected[seed.prefixId]) continue;
+        BGP* bgp = dynamic_cast<BGP*>(nodes[seed.index].policy.get());
+        if (bgp) bgp->seedAnnouncement(seed.prefixId, nodes[seed.index].asn, seed.rovInvalid, paths);
+    }
+
+    bool propagated = propagateAnnouncements();
+    scopedToRegion = false;
+    regionNodes.clear();
+    regionRanks.clear();
+
+    // Prefixes never interact, so the unaffected routes merge straight back.
+    // An AS that held nothing got its new routes in place already.
+    runWorkers([&](unsigned worker) {
+        for (size_t i = 0; i < setAside.size(); i++) {
+            uint32_t index = setAside[i];
+            if (!ownedBy(index, worker)) continue;
+            BGP* bgp = dynamic_cast<BGP*>(nodes[index].policy.get());
+            if (!bgp) continue;
+            RIB& routes = converged[i];
+            if (affectedIds.size() <= POINT_UPDATE_PREFIXES) {
+                // A route kept for the prefix is overwritten where it sits;
+                // only a gained or lost one moves the rest of the RIB
+                for (PrefixId prefixId : affectedIds) {
+                    const Announcement* route = bgp->localRIB.find(prefixId);
+                    if (route) {
+                        routes.insertOrAssign(*route);
+                    } else {
+                        routes.erase(prefixId);
+                    }
+                }
+            } else {
+                routes.removeIf([&](const Announcement& route) { return affected[route.prefixId]; });
+                routes.insertSorted(bgp->localRIB);
+            }
+            std::swap(routes, bgp->localRIB);
+        }
+    });
+    return propagated && allApplied;
+}
+
+// Every AS a route from origins can reach: their providers' chains up, one
+// peer hop off any of those, then everything below, in ascending node
+// order. Gives up, returning false, once more than limit ASes are reached.
+bool ASGraph::valleyFreeReach(const std::vector<uint32_t>& origins, size_t limit,
+                              std::vector<uint32_t>& region) const {
+    std::vector<uint8_t> reached(nodes.size(), 0);
+    region.clear();
+    auto reach = [&](uint32_t index) {
+        if (reached[index]) return;
+        reached[index] = 1;
+        region.push_back(index);
+    };
+
+    for (uint32_t origin : origins) reach(origin);
+    for (size_t next = 0; next < region.size(); next++) {
+        for (uint32_t provider : topology.providers(region[next])) reach(provider);
+    }
+    size_t climbed = region.size();
+    for (size_t i = 0; i < climbed; i++) {
+        for (uint32_t peer : topology.peers(region[i])) reach(peer);
+    }
+    for (size_t next = 0; next < region.size() && region.size() <= limit; next++) {
+        for (uint32_t customer : topology.customers(region[next])) reach(customer);
+    }
+    if (region.size() > limit) {
+        region.clear();
+        return false;
+    }
+
+    std::sort(region.begin(), region.end());
+    return true;
+}
@@ -0,0 +1,129 @@
+#include "ScenarioBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+bool ScenarioBatch::loadManifest(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening scenario manifest: " << filename << std::endl;
+        return false;
+    }
+
+    scenarios.clear();
+    std::string line;
+    bool firstLine = true;
+    size_t lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (firstLine) {
+            firstLine = false;
+            continue; // Skip header
+        }
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        Scenario scenario;
+        if (!std::getline(iss, scenario.announcementsFile, ',') ||
+            !std::getline(iss, scenario.rovASNsFile, ',') ||
+            !std::getline(iss, scenario.outputFile) ||
+            scenario.announcementsFile.empty() || scenario.rovASNsFile.empty() || scenario.outputFile.empty()) {
+            std::cerr << "Malformed scenario on line " << lineNumber << " of " << filename
+                      << " (expected announcements,rov_asns,output)" << std::endl;
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+
+    if (scenarios.empty()) {
+        std::cerr << "Scenario manifest lists no scenarios: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ScenarioBatch::runScenario(ASGraph& graph, const Scenario& scenario, size_t& routes) const {
+    graph.resetRoutingState();
+
+    std::set<int> rovASNs;
+    if (!graph.loadROVASNs(scenario.rovASNsFile, rovASNs)) {
+        return false;
+    }
+    graph.initializeBGPPolicies(rovASNs);
+    if (!graph.loadAnnouncementsFromCSV(scenario.announcementsFile)) {
+        return false;
+    }
+
+    if (!graph.propagateAnnouncements()) {
+        return false;
+    }
+
+    if (binaryOutput) {
+        if (!graph.outputToBinary(scenario.outputFile)) {
+            return false;
+        }
+    } else if (!graph.outputToCSV(scenario.outputFile)) {
+        return false;
+    }
+
+    routes = graph.routeCount();
+    return true;
+}
+
+bool ScenarioBatch::run(const ASGraph& topologySource) {
+    std::atomic<size_t> nextScenario(0);
+    std::atomic<size_t> failures(0);
+    std::mutex logMutex;
+
+    // Each runner owns one graph for its whole lifetime and pulls scenarios
+    // until none are left, so the topology is copied once per runner
+    auto runner = [&]() {
+        ASGraph graph;
+        if (!graph.setThreadCount(threadsPerScenario) || !graph.setPrefixShards(prefixShards)) {
+            failures++;
+            return;
+        }
+        graph.setImplicitStubs(implicitStubs);
+        graph.engine = engine;
+        graph.copyTopology(topologySource);
+
+        for (size_t i = nextScenario++; i < scenarios.size(); i = nextScenario++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t routes = 0;
+            bool ok = runScenario(graph, scenarios[i], routes);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (ok) {
+                std::cout << "Scenario " << i + 1 << "/" << scenarios.size() << ": " << routes
+                          << " routes -> " << scenarios[i].outputFile << " in " << duration.count() << "ms" << std::endl;
+            } else {
+                failures++;
+                std::cerr << "Scenario " << i + 1 << "/" << scenarios.size() << " failed ("
+                          << scenarios[i].announcementsFile << ", " << scenarios[i].rovASNsFile << ")" << std::endl;
+            }
+        }
+    };
+
+    unsigned runners = std::max(1u, std::min<unsigned>(concurrentScenarios, static_cast<unsigned>(scenarios.size())));
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < runners; i++) {
+        threads.emplace_back(runner);
+    }
+    runner();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return failures == 0;
+}
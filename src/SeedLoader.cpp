@@ -0,0 +1,168 @@
+#include "ASGraph.h"
+#include "MappedFile.h"
+#include "Policy.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <typeinfo>
+
+// Announcement seeding. Full-table inputs hold millions of (origin, prefix)
+// rows, so the file is memory-mapped and parsed in place into a compact seed
+// table, which is then ordered by origin and prefix and seeded one origin at
+// a time. Time and memory are linear in the number of rows.
+
+namespace {
+
+// Parse "asn,prefix,rov_invalid" in [p, eol); prefix views the line
+bool parseSeed(const char* p, const char* eol, int& asn, std::string_view& prefix, bool& rovInvalid) {
+    if (eol > p && eol[-1] == '\r') eol--;
+
+    auto result = std::from_chars(p, eol, asn);
+    if (result.ec != std::errc() || result.ptr == eol || *result.ptr != ',') {
+        return false;
+    }
+    p = result.ptr + 1;
+
+    const char* comma = static_cast<const char*>(std::memchr(p, ',', eol - p));
+    if (!comma || comma + 1 == eol) {
+        return false;
+    }
+    prefix = std::string_view(p, comma - p);
+
+    std::string_view flag(comma + 1, eol - comma - 1);
+    rovInvalid = flag == "true" || flag == "True" || flag == "1";
+    return true;
+}
+
+// Stable counting sort of rows by key(row), which must be below keyCount
+template <typename Row, typename Key>
+void countingSort(std::vector<Row>& rows, std::vector<Row>& scratch, size_t keyCount, Key key) {
+    std::vector<size_t> offsets(keyCount + 1, 0);
+    for (const Row& row : rows) {
+        offsets[key(row) + 1]++;
+    }
+    for (size_t k = 0; k < keyCount; k++) {
+        offsets[k + 1] += offsets[k];
+    }
+    scratch.resize(rows.size());
+    for (const Row& row : rows) {
+        scratch[offsets[key(row)]++] = row;
+    }
+    rows.swap(scratch);
+}
+
+} // namespace
+
+bool ASGraph::loadAnnouncementsFromCSV(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening announcements file: " << filename << std::endl;
+        return false;
+    }
+
+    // Whether each origin's policy can seed, looked up once per AS:
+    // 0 not yet looked up, 1 BGP-based, 2 not
+    std::vector<uint8_t> seedable(nodes.size(), 0);
+    std::vector<Seed> loaded;
+    // Rows run a little over 20 bytes, and each adds at most one prefix, so
+    // neither the table nor the prefix index regrows while parsing
+    loaded.reserve(file.size() / 24);
+    prefixes.reserve(prefixes.size() + loaded.capacity());
+
+    int lastASN = 0;
+    int lastIndex = -1;
+    bool header = true;
+    const char* line = file.begin();
+    while (line < file.end()) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', file.end() - line));
+        if (!eol) eol = file.end();
+
+        int asn;
+        std::string_view prefix;
+        bool rovInvalid;
+        if (header) {
+            header = false;
+        } else if (line != eol && parseSeed(line, eol, asn, prefix, rovInvalid)) {
+            // Full-table dumps list each origin's prefixes together
+            if (lastIndex < 0 || asn != lastASN) {
+                lastASN = asn;
+                lastIndex = topology.indexOf(asn);
+            }
+            if (lastIndex >= 0) {
+                uint8_t& state = seedable[lastIndex];
+                if (state == 0) {
+                    state = dynamic_cast<BGP*>(nodes[lastIndex].policy.get()) ? 1 : 2;
+                }
+                if (state == 1) {
+                    loaded.push_back({static_cast<uint32_t>(lastIndex), prefixes.intern(prefix), rovInvalid});
+                }
+            }
+        }
+        line = eol + 1;
+    }
+
+    file.close();
+    seedInBulk(loaded);
+    return true;
+}
+
+void ASGraph::seedInBulk(std::vector<Seed>& loaded) {
+    // Sorting by prefix and then, stably, by origin orders the table by
+    // (origin, prefix) in linear time; repeated rows keep their file order
+    {
+        std::vector<Seed> scratch;
+        countingSort(loaded, scratch, prefixes.size(), [](const Seed& seed) { return seed.prefixId; });
+        countingSort(loaded, scratch, nodes.size(), [](const Seed& seed) { return seed.index; });
+    }
+
+    std::vector<Announcement> additions;
+    for (size_t first = 0; first < loaded.size();) {
+        uint32_t index = loaded[first].index;
+        size_t last = first;
+        while (last < loaded.size() && loaded[last].index == index) last++;
+
+        BGP* bgp = static_cast<BGP*>(nodes[index].policy.get());
+        int asn = nodes[index].asn;
+        const Policy& policy = *bgp;
+        bool builtIn = typeid(policy) == typeid(BGP) || typeid(policy) == typeid(ROV);
+
+        if (builtIn && bgp->localRIB.empty()) {
+            // The rows are sorted by prefix, so the origin's RIB is built in
+            // one pass; a repeated prefix keeps its last row, as reseeding would
+            bool dropInvalid = bgp->dropsInvalid();
+            Announcement announcement;
+            announcement.pathLength = 1;
+            announcement.nextHopASN = asn;
+            announcement.receivedFrom = Relationship::ORIGIN;
+            additions.clear();
+            for (size_t i = first; i < last; i++) {
+                const Seed& seed = loaded[i];
+                if (dropInvalid && seed.rovInvalid) continue;
+                if (additions.empty()) {
+                    announcement.asPath = paths.prepend(asn, PathStore::EMPTY);
+                }
+                announcement.prefixId = seed.prefixId;
+                announcement.rovInvalid = seed.rovInvalid;
+                if (!additions.empty() && additions.back().prefixId == seed.prefixId) {
+                    additions.back() = announcement;
+                } else {
+                    additions.push_back(announcement);
+                }
+            }
+            bgp->localRIB.insertSorted(additions);
+        } else {
+            // Custom policies decide for themselves what a seed means
+            for (size_t i = first; i < last; i++) {
+                bgp->seedAnnouncement(loaded[i].prefixId, asn, loaded[i].rovInvalid, paths);
+            }
+        }
+        first = last;
+    }
+
+    if (seeds.empty()) {
+        seeds.swap(loaded);
+    } else {
+        seeds.insert(seeds.end(), loaded.begin(), loaded.end());
+    }
+}
@@ -0,0 +1,176 @@
+#include "SyntheticTopology.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Draws are taken straight from the engine rather than through the standard
+// distributions, whose output differs between standard libraries
+class Random {
+public:
+    explicit Random(uint64_t seed) : engine(seed) {}
+
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(engine() % n); }
+    bool chance(double p) { return (engine() >> 11) * 0x1.0p-53 < p; }
+
+private:
+    std::mt19937_64 engine;
+};
+
+uint64_t pairKey(uint32_t a, uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Collects text in a large buffer and writes it out in big blocks
+class TextFile {
+public:
+    explicit TextFile(const std::string& filename) : filename(filename), file(filename, std::ios::binary) {
+        if (!file.is_open()) {
+            std::cerr << "Error opening output file: " << filename << std::endl;
+        }
+        buffer.reserve(FLUSH_THRESHOLD + 256);
+    }
+
+    bool isOpen() const { return file.is_open(); }
+
+    TextFile& operator<<(const std::string& text) {
+        buffer += text;
+        if (buffer.size() >= FLUSH_THRESHOLD) flush();
+        return *this;
+    }
+    TextFile& operator<<(int value) { return *this << std::to_string(value); }
+
+    bool close() {
+        flush();
+        file.close();
+        if (file.fail()) {
+            std::cerr << "Error writing output file: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD = 1 << 22;
+
+    std::string filename;
+    std::ofstream file;
+    std::string buffer;
+
+    void flush() {
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+};
+
+} // namespace
+
+bool SyntheticTopology::write(const std::string& directory) const {
+    if (tier1Count == 0 || asCount <= tier1Count) {
+        std::cerr << "Synthetic topology needs more ASes than tier-1 ASes (and at least one tier-1)" << std::endl;
+        return false;
+    }
+    // Prefixes are numbered /24s from 1.0.0.0 up through 223.255.255.0
+    if (prefixCount > 223u * 65536u) {
+        std::cerr << "Synthetic topology supports at most " << 223u * 65536u << " prefixes" << std::endl;
+        return false;
+    }
+
+    Random random(seed);
+
+    // ASes are created in hierarchy order but named in random order
+    std::vector<int> asns(asCount);
+    std::iota(asns.begin(), asns.end(), 1);
+    for (uint32_t i = asCount - 1; i > 0; i--) {
+        std::swap(asns[i], asns[random.below(i + 1)]);
+    }
+
+    std::unordered_set<uint64_t> linked;
+    linked.reserve(static_cast<size_t>(asCount * (2.0 + peersPerAS)));
+    std::vector<uint64_t> customerEdges;  // provider << 32 | customer
+    std::vector<uint64_t> peerEdges;
+
+    // Every AS that can sell transit appears once, plus once per customer it
+    // has, so drawing from the pool favors well-connected providers
+    std::vector<uint32_t> providerPool;
+    for (uint32_t a = 0; a < tier1Count; a++) {
+        providerPool.insert(providerPool.end(), 4, a);
+        for (uint32_t b = a + 1; b < tier1Count; b++) {
+            linked.insert(pairKey(a, b));
+            peerEdges.push_back(pairKey(a, b));
+        }
+    }
+
+    for (uint32_t as = tier1Count; as < asCount; as++) {
+        // One to three providers, all created earlier, so no cycles can form
+        uint32_t wanted = 1 + random.chance(0.4) + random.chance(0.15);
+        uint32_t found = 0;
+        for (uint32_t attempt = 0; found < wanted && attempt < 8 * wanted; attempt++) {
+            uint32_t provider = providerPool[random.below(static_cast<uint32_t>(providerPool.size()))];
+            if (linked.insert(pairKey(provider, as)).second) {
+                customerEdges.push_back((static_cast<uint64_t>(provider) << 32) | as);
+                providerPool.push_back(provider);
+                found++;
+            }
+        }
+        if (random.chance(transitFraction)) {
+            providerPool.push_back(as);
+        }
+    }
+
+    // Peering mostly involves transit networks, with stubs joining in at
+    // exchange points; a pair that already has a relationship is skipped
+    uint64_t peerTarget = static_cast<uint64_t>(peersPerAS * asCount / 2);
+    for (uint64_t attempt = 0; peerEdges.size() < peerTarget && attempt < 4 * peerTarget; attempt++) {
+        uint32_t a = providerPool[random.below(static_cast<uint32_t>(providerPool.size()))];
+        uint32_t b = random.chance(0.5) ? providerPool[random.below(static_cast<uint32_t>(providerPool.size()))]
+                                        : random.below(asCount);
+        if (a != b && linked.insert(pairKey(a, b)).second) {
+            peerEdges.push_back(pairKey(a, b));
+        }
+    }
+
+    TextFile relationships(directory + "/relationships.txt");
+    if (!relationships.isOpen()) return false;
+    relationships << "# synthetic CAIDA-style topology: " << static_cast<int>(asCount) << " ASes, seed "
+                  << std::to_string(seed) << "\n# source:synthetic\n";
+    for (uint64_t edge : customerEdges) {
+        relationships << asns[edge >> 32] << "|" << asns[static_cast<uint32_t>(edge)] << "|-1|bgp\n";
+    }
+    for (uint64_t edge : peerEdges) {
+        relationships << asns[edge >> 32] << "|" << asns[static_cast<uint32_t>(edge)] << "|0|bgp\n";
+    }
+    if (!relationships.close()) return false;
+
+    TextFile announcements(directory + "/anns.csv");
+    if (!announcements.isOpen()) return false;
+    announcements << "seed_asn,prefix,rov_invalid\n";
+    for (uint32_t i = 0; i < prefixCount; i++) {
+        std::string prefix = std::to_string(1 + (i >> 16)) + "." + std::to_string((i >> 8) & 0xFF) + "." +
+                             std::to_string(i & 0xFF) + ".0/24";
+        uint32_t origin = random.below(asCount);
+        announcements << asns[origin] << "," << prefix << ",False\n";
+        if (random.chance(hijackFraction)) {
+            uint32_t attacker = random.below(asCount - 1);
+            if (attacker >= origin) attacker++;
+            announcements << asns[attacker] << "," << prefix << ",True\n";
+        }
+    }
+    if (!announcements.close()) return false;
+
+    TextFile rov(directory + "/rov_asns.csv");
+    if (!rov.isOpen()) return false;
+    rov << "asn\n";
+    for (uint32_t as = 0; as < asCount; as++) {
+        if (random.chance(rovFraction)) {
+            rov << asns[as] << "\n";
+        }
+    }
+    return rov.close();
+}
@@ -0,0 +1,62 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    for (unsigned worker = 1; worker < threads; worker++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCv.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(const std::function<void(unsigned)>& task) {
+    if (workers.empty()) {
+        task(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        pending = static_cast<unsigned>(workers.size());
+        generation++;
+    }
+    startCv.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return pending == 0; });
+    currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    unsigned long seen = 0;
+    while (true) {
+        const std::function<void(unsigned)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            task = currentTask;
+        }
+
+        (*task)(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                doneCv.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include "Topology.h"
+#include <algorithm>
+
+namespace {
+
+// LSD radix sort on the upper 32 bits of each key. Stable, so the lower
+// 32 bits keep their original order within equal upper halves.
+void radixSortHigh(std::vector<uint64_t>& keys) {
+    std::vector<uint64_t> buffer(keys.size());
+    for (int shift = 32; shift < 64; shift += 8) {
+        size_t counts[257] = {};
+        for (uint64_t key : keys) {
+            counts[((key >> shift) & 0xFF) + 1]++;
+        }
+        for (int i = 0; i < 256; i++) {
+            counts[i + 1] += counts[i];
+        }
+        for (uint64_t key : keys) {
+            buffer[counts[(key >> shift) & 0xFF]++] = key;
+        }
+        keys.swap(buffer);
+    }
+}
+
+// Lay out (from, to) pairs as CSR with a counting sort, then sort and
+// deduplicate each node's neighbor list in place
+void buildCSR(size_t nodeCount, const std::vector<uint64_t>& pairs,
+              std::vector<uint32_t>& offsets, std::vector<uint32_t>& list) {
+    std::vector<uint32_t> cursor(nodeCount + 1, 0);
+    for (uint64_t pair : pairs) {
+        cursor[(pair >> 32) + 1]++;
+    }
+    for (size_t i = 0; i < nodeCount; i++) {
+        cursor[i + 1] += cursor[i];
+    }
+
+    list.resize(pairs.size());
+    std::vector<uint32_t> fill(cursor.begin(), cursor.end() - 1);
+    for (uint64_t pair : pairs) {
+        list[fill[pair >> 32]++] = static_cast<uint32_t>(pair);
+    }
+
+    offsets.assign(nodeCount + 1, 0);
+    uint32_t out = 0;
+    for (size_t node = 0; node < nodeCount; node++) {
+        auto first = list.begin() + cursor[node];
+        auto last = list.begin() + cursor[node + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+        out = static_cast<uint32_t>(std::copy(first, last, list.begin() + out) - list.begin());
+        offsets[node + 1] = out;
+    }
+    list.resize(out);
+    list.shrink_to_fit();
+}
+
+uint64_t packPair(uint32_t from, uint32_t to) {
+    return (static_cast<uint64_t>(from) << 32) | to;
+}
+
+} // namespace
+
+void Topology::build(const std::vector<RelationshipEdge>& edges) {
+    // Sort every endpoint by ASN while remembering which edge slot it came
+    // from; flipping the sign bit keeps signed order under unsigned sorting
+    std::vector<uint64_t> endpoints;
+    endpoints.reserve(edges.size() * 2);
+    for (size_t i = 0; i < edges.size(); i++) {
+        endpoints.push_back(packPair(static_cast<uint32_t>(edges[i].as1) ^ 0x80000000u, 2 * i));
+        endpoints.push_back(packPair(static_cast<uint32_t>(edges[i].as2) ^ 0x80000000u, 2 * i + 1));
+    }
+    radixSortHigh(endpoints);
+
+    // Walk the sorted endpoints to assign dense indices in ASN order
+    asns.clear();
+    std::vector<uint32_t> slotIndex(endpoints.size());
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        int asn = static_cast<int>(static_cast<uint32_t>(endpoints[i] >> 32) ^ 0x80000000u);
+        if (asns.empty() || asns.back() != asn) {
+            asns.push_back(asn);
+        }
+        slotIndex[static_cast<uint32_t>(endpoints[i])] = static_cast<uint32_t>(asns.size() - 1);
+    }
+    asns.shrink_to_fit();
+    endpoints.clear();
+    endpoints.shrink_to_fit();
+
+    std::vector<uint64_t> providerPairs;
+    std::vector<uint64_t> customerPairs;
+    std::vector<uint64_t> peerPairs;
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        uint32_t a = slotIndex[2 * i];
+        uint32_t b = slotIndex[2 * i + 1];
+        int relationship = edges[i].relationship;
+
+        if (relationship == -1) {
+            // CAIDA standard: Provider-to-Customer (AS1 → AS2)
+            customerPairs.push_back(packPair(a, b));
+            providerPairs.push_back(packPair(b, a));
+        } else if (relationship == 0 || relationship == 1) {
+            // Peer-to-Peer; siblings are treated as peers
+            peerPairs.push_back(packPair(a, b));
+            peerPairs.push_back(packPair(b, a));
+        }
+    }
+
+    buildCSR(asns.size(), providerPairs, providerOffsets, providerList);
+    buildCSR(asns.size(), customerPairs, customerOffsets, customerList);
+    buildCSR(asns.size(), peerPairs, peerOffsets, peerList);
+}
+
+int Topology::indexOf(int asn) const {
+    auto it = std::lower_bound(asns.begin(), asns.end(), asn);
+    if (it == asns.end() || *it != asn) {
+        return -1;
+    }
+    return static_cast<int>(it - asns.begin());
+}
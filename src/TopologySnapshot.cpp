@@ -0,0 +1,239 @@
+#include "ASGraph.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Binary topology snapshot: the frozen CSR arrays plus propagation ranks, so
+// repeated runs over one CAIDA file skip parsing, cycle checks and flattening.
+//
+// Layout (native byte order, every field 4-byte aligned):
+//   SnapshotHeader
+//   int32  asns[nodeCount]
+//   uint32 providerOffsets[nodeCount + 1], providerList[providerCount]
+//   uint32 customerOffsets[nodeCount + 1], customerList[customerCount]
+//   uint32 peerOffsets[nodeCount + 1],     peerList[peerCount]
+//   uint32 rankSizes[rankCount],           rankNodes[sum of rankSizes]
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'B', 'G', 'P', 'T', 'O', 'P', 'O', '\0'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint64_t providerCount;
+    uint64_t customerCount;
+    uint64_t peerCount;
+    uint64_t rankCount;
+};
+
+template <typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& values) {
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+// Sequential reader over the snapshot file. Arrays are read straight into
+// their vectors, so each byte is copied once, from the page cache.
+class SnapshotReader {
+public:
+    SnapshotReader(std::ifstream& file, uint64_t remaining) : file(file), remaining(remaining) {}
+
+    // Counts come from the file, so they are bounded by what is left before
+    // anything is multiplied or allocated
+    template <typename T>
+    bool read(std::vector<T>& values, uint64_t count) {
+        if (count > remaining / sizeof(T)) return false;
+        uint64_t bytes = count * sizeof(T);
+        values.resize(count);
+        if (!file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(bytes))) return false;
+        remaining -= bytes;
+        return true;
+    }
+
+    bool atEnd() const { return remaining == 0; }
+
+private:
+    std::ifstream& file;
+    uint64_t remaining;
+};
+
+// Offsets must be monotonic and every neighbor must be a valid node
+bool validCSR(const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& list, uint32_t nodeCount) {
+    if (offsets.front() != 0 || offsets.back() != list.size()) return false;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        if (offsets[i] > offsets[i + 1]) return false;
+    }
+    for (uint32_t neighbor : list) {
+        if (neighbor >= nodeCount) return false;
+    }
+    return true;
+}
+
+// indexOf binary-searches the ASNs
+bool strictlyIncreasing(const std::vector<int>& asns) {
+    for (size_t i = 1; i < asns.size(); i++) {
+        if (asns[i - 1] >= asns[i]) return false;
+    }
+    return true;
+}
+
+// Every node must sit in exactly one rank, above all of its customers, as
+// flattenGraph places them; fills in each node's rank
+bool validRanks(const Topology& topology, const std::vector<uint32_t>& rankSizes,
+                const std::vector<uint32_t>& rankNodes, std::vector<uint32_t>& rankOf) {
+    uint32_t nodeCount = static_cast<uint32_t>(topology.size());
+    if (rankNodes.size() != nodeCount) return false;
+
+    const uint32_t UNRANKED = UINT32_MAX;
+    rankOf.assign(nodeCount, UNRANKED);
+    size_t next = 0;
+    for (uint32_t rank = 0; rank < rankSizes.size(); rank++) {
+        for (uint32_t i = 0; i < rankSizes[rank]; i++, next++) {
+            uint32_t index = rankNodes[next];
+            if (index >= nodeCount || rankOf[index] != UNRANKED) return false;
+            rankOf[index] = rank;
+        }
+    }
+
+    for (uint32_t index = 0; index < nodeCount; index++) {
+        for (uint32_t customer : topology.customers(index)) {
+            if (rankOf[customer] >= rankOf[index]) return false;
+        }
+        for (uint32_t provider : topology.providers(index)) {
+            if (rankOf[provider] <= rankOf[index]) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ASGraph::saveTopology(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening topology snapshot for writing: " << filename << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.nodeCount = static_cast<uint32_t>(topology.size());
+    header.providerCount = topology.providerList.size();
+    header.customerCount = topology.customerList.size();
+    header.peerCount = topology.peerList.size();
+    header.rankCount = propagationRanks.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    writeArray(file, topology.asns);
+    writeArray(file, topology.providerOffsets);
+    writeArray(file, topology.providerList);
+    writeArray(file, topology.customerOffsets);
+    writeArray(file, topology.customerList);
+    writeArray(file, topology.peerOffsets);
+    writeArray(file, topology.peerList);
+
+    std::vector<uint32_t> rankSizes;
+    for (const auto& rank : propagationRanks) {
+        rankSizes.push_back(static_cast<uint32_t>(rank.size()));
+    }
+    writeArray(file, rankSizes);
+    for (const auto& rank : propagationRanks) {
+        writeArray(file, rank);
+    }
+
+    if (!file.good()) {
+        std::cerr << "Error writing topology snapshot: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ASGraph::loadTopology(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Error opening topology snapshot: " << filename << std::endl;
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    SnapshotHeader header;
+    if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Topology snapshot is truncated: " << filename << std::endl;
+        return false;
+    }
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "Not a topology snapshot: " << filename << std::endl;
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        std::cerr << "Unsupported topology snapshot version " << header.version
+                  << " (expected " << SNAPSHOT_VERSION << "): " << filename << std::endl;
+        return false;
+    }
+
+    Topology loaded;
+    std::vector<uint32_t> rankSizes;
+    std::vector<uint32_t> rankNodes;
+    uint32_t n = header.nodeCount;
+
+    SnapshotReader reader(file, size - sizeof(header));
+    bool ok = reader.read(loaded.asns, n) &&
+              reader.read(loaded.providerOffsets, uint64_t(n) + 1) &&
+              reader.read(loaded.providerList, header.providerCount) &&
+              reader.read(loaded.customerOffsets, uint64_t(n) + 1) &&
+              reader.read(loaded.customerList, header.customerCount) &&
+              reader.read(loaded.peerOffsets, uint64_t(n) + 1) &&
+              reader.read(loaded.peerList, header.peerCount) &&
+              reader.read(rankSizes, header.rankCount);
+
+    uint64_t rankTotal = 0;
+    for (uint32_t size : rankSizes) {
+        rankTotal += size;
+    }
+    ok = ok && reader.read(rankNodes, rankTotal) && reader.atEnd();
+    if (!ok) {
+        std::cerr << "Topology snapshot is truncated or has trailing data: " << filename << std::endl;
+        return false;
+    }
+
+    if (!validCSR(loaded.providerOffsets, loaded.providerList, n) ||
+        !validCSR(loaded.customerOffsets, loaded.customerList, n) ||
+        !validCSR(loaded.peerOffsets, loaded.peerList, n)) {
+        std::cerr << "Topology snapshot is corrupt (bad neighbor lists): " << filename << std::endl;
+        return false;
+    }
+    if (!strictlyIncreasing(loaded.asns)) {
+        std::cerr << "Topology snapshot is corrupt (ASNs not sorted): " << filename << std::endl;
+        return false;
+    }
+    std::vector<uint32_t> rankOf;
+    if (!validRanks(loaded, rankSizes, rankNodes, rankOf)) {
+        std::cerr << "Topology snapshot is corrupt (ranks do not cover every AS above its customers): " << filename
+                  << std::endl;
+        return false;
+    }
+
+    topology = std::move(loaded);
+    pendingEdges.clear();
+    nodes.clear();
+    nodes.reserve(topology.size());
+    for (int asn : topology.asns) {
+        nodes.emplace_back(asn);
+    }
+
+    propagationRanks.assign(rankSizes.size(), {});
+    size_t next = 0;
+    for (size_t rank = 0; rank < rankSizes.size(); rank++) {
+        propagationRanks[rank].assign(rankNodes.begin() + next, rankNodes.begin() + next + rankSizes[rank]);
+        next += rankSizes[rank];
+    }
+    for (uint32_t index = 0; index < n; index++) {
+        nodes[index].propagationRank = static_cast<int>(rankOf[index]);
+    }
+    return true;
+}
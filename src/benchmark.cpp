@@ -0,0 +1,348 @@
+#include "ASGraph.h"
+#include "Policy.h"
+#include "SyntheticTopology.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Times each pipeline stage separately over the bench datasets and over
+// generated topologies, repeating every run so regressions can be told
+// apart from noise.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Dataset {
+    std::string name;
+    std::string relationshipsFile;
+    std::string announcementsFile;
+    std::string rovASNsFile;
+};
+
+const char* STAGES[] = {"load", "flatten", "seed", "propagate", "output"};
+const size_t STAGE_COUNT = sizeof(STAGES) / sizeof(STAGES[0]);
+
+struct Summary {
+    double mean = 0;
+    double stddev = 0;  // sample standard deviation
+    double min = 0;
+    double max = 0;
+};
+
+Summary summarize(const std::vector<double>& samples) {
+    Summary summary;
+    if (samples.empty()) return summary;
+    summary.min = *std::min_element(samples.begin(), samples.end());
+    summary.max = *std::max_element(samples.begin(), samples.end());
+    for (double sample : samples) {
+        summary.mean += sample;
+    }
+    summary.mean /= samples.size();
+    if (samples.size() > 1) {
+        double squares = 0;
+        for (double sample : samples) {
+            squares += (sample - summary.mean) * (sample - summary.mean);
+        }
+        summary.stddev = std::sqrt(squares / (samples.size() - 1));
+    }
+    return summary;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A bench dataset directory holds one CAIDA .txt file plus anns.csv and rov_asns.csv
+bool findBenchDataset(const fs::path& directory, Dataset& dataset) {
+    std::error_code error;
+    if (!fs::is_directory(directory, error)) return false;
+
+    std::vector<fs::path> candidates;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+            candidates.push_back(entry.path());
+        }
+    }
+    if (candidates.empty() || !fs::exists(directory / "anns.csv") || !fs::exists(directory / "rov_asns.csv")) {
+        return false;
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    dataset.name = directory.filename().string();
+    dataset.relationshipsFile = candidates.front().string();
+    dataset.announcementsFile = (directory / "anns.csv").string();
+    dataset.rovASNsFile = (directory / "rov_asns.csv").string();
+    return true;
+}
+
+// --synthetic <ases>[,<peers-per-as>[,<prefixes>]]
+bool parseSynthetic(const std::string& spec, SyntheticTopology& topology) {
+    std::istringstream iss(spec);
+    std::string field;
+    std::vector<std::string> fields;
+    while (std::getline(iss, field, ',')) {
+        fields.push_back(field);
+    }
+    if (fields.empty() || fields.size() > 3) return false;
+
+    char* end = nullptr;
+    topology.asCount = static_cast<uint32_t>(std::strtoul(fields[0].c_str(), &end, 10));
+    if (*end != '\0' || topology.asCount == 0) return false;
+    if (fields.size() > 1) {
+        topology.peersPerAS = std::strtod(fields[1].c_str(), &end);
+        if (*end != '\0' || topology.peersPerAS < 0) return false;
+    }
+    if (fields.size() > 2) {
+        topology.prefixCount = static_cast<uint32_t>(std::strtoul(fields[2].c_str(), &end, 10));
+        if (*end != '\0') return false;
+    }
+    return true;
+}
+
+// One full pipeline run; fills in the time of each stage
+bool runOnce(const Dataset& dataset, unsigned threads, PropagationEngine engine, bool implicitStubs,
+             const std::string& outputFile, std::vector<double>& stageTimes, size_t& nodeCount, size_t& routeCount) {
+    ASGraph graph;
+    if (!graph.setThreadCount(threads)) return false;
+    graph.setImplicitStubs(implicitStubs);
+    graph.engine = engine;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!graph.loadFromFile(dataset.relationshipsFile)) return false;
+    stageTimes[0] = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<int> cycle;
+    if (graph.findProviderCycle(cycle)) {
+        std::cerr << "Provider cycle in " << dataset.relationshipsFile << std::endl;
+        return false;
+    }
+    graph.flattenGraph();
+    stageTimes[1] = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::set<int> rovASNs;
+    if (!graph.loadROVASNs(dataset.rovASNsFile, rovASNs)) return false;
+    graph.initializeBGPPolicies(rovASNs);
+    if (!graph.loadAnnouncementsFromCSV(dataset.announcementsFile)) return false;
+    stageTimes[2] = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!graph.propagateAnnouncements()) return false;
+    stageTimes[3] = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!graph.outputToCSV(outputFile)) return false;
+    stageTimes[4] = millisecondsSince(start);
+
+    nodeCount = graph.nodes.size();
+    routeCount = graph.routeCount();
+    return true;
+}
+
+void printUsage(const char* programName) {
+    std::cerr << "Usage: " << programName << " [options]" << std::endl;
+    std::cerr << "  --bench-dir: directory holding the prefix, subprefix and many datasets (default bench)" << std::endl;
+    std::cerr << "  --dataset: run only this bench dataset; repeat for several (default: every one found)" << std::endl;
+    std::cerr << "  --synthetic: generated topology <ases>[,<peers-per-as>[,<prefixes>]]; repeatable (default peers 2, prefixes 50)" << std::endl;
+    std::cerr << "  --seed: generator seed (default 1)" << std::endl;
+    std::cerr << "  --repetitions: runs per dataset (default 5)" << std::endl;
+    std::cerr << "  --threads: worker threads for propagation (default 1)" << std::endl;
+    std::cerr << "  --engine: push (default) or pull" << std::endl;
+    std::cerr << "  --implicit-stubs: derive single-homed stub RIBs at output instead of propagating them" << std::endl;
+    std::cerr << "  --work-dir: where generated inputs and RIB outputs go (default bench_work)" << std::endl;
+    std::cerr << "  --results: append one CSV row per dataset and stage to this file" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string benchDir = "bench";
+    std::vector<std::string> datasetNames;
+    std::vector<SyntheticTopology> synthetics;
+    uint64_t seed = 1;
+    int repetitions = 5;
+    int threads = 1;
+    PropagationEngine engine = PropagationEngine::PUSH;
+    bool implicitStubs = false;
+    std::string workDir = "bench_work";
+    std::string resultsFile;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench-dir") == 0 && i + 1 < argc) {
+            benchDir = argv[++i];
+        } else if (strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) {
+            datasetNames.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--synthetic") == 0 && i + 1 < argc) {
+            SyntheticTopology topology;
+            if (!parseSynthetic(argv[++i], topology)) {
+                std::cerr << "Error: --synthetic expects <ases>[,<peers-per-as>[,<prefixes>]], got " << argv[i] << std::endl;
+                return 1;
+            }
+            synthetics.push_back(topology);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+            if (repetitions < 1) {
+                std::cerr << "Error: --repetitions must be at least 1" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) {
+                std::cerr << "Error: --threads must be at least 1" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "pull") == 0) {
+                engine = PropagationEngine::PULL;
+            } else if (strcmp(name, "push") == 0) {
+                engine = PropagationEngine::PUSH;
+            } else {
+                std::cerr << "Unknown engine: " << name << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--implicit-stubs") == 0) {
+            implicitStubs = true;
+        } else if (strcmp(argv[i], "--work-dir") == 0 && i + 1 < argc) {
+            workDir = argv[++i];
+        } else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            resultsFile = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    fs::create_directories(workDir, error);
+    if (error) {
+        std::cerr << "Error creating work directory " << workDir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    std::vector<Dataset> datasets;
+    if (datasetNames.empty() && synthetics.empty()) {
+        datasetNames = {"prefix", "subprefix", "many"};
+        for (const auto& name : datasetNames) {
+            Dataset dataset;
+            if (findBenchDataset(fs::path(benchDir) / name, dataset)) {
+                datasets.push_back(dataset);
+            } else {
+                std::cout << "Skipping " << name << ": no dataset in " << (fs::path(benchDir) / name).string() << std::endl;
+            }
+        }
+    } else {
+        for (const auto& name : datasetNames) {
+            Dataset dataset;
+            if (!findBenchDataset(fs::path(benchDir) / name, dataset)) {
+                std::cerr << "No dataset (CAIDA .txt, anns.csv, rov_asns.csv) in "
+                          << (fs::path(benchDir) / name).string() << std::endl;
+                return 1;
+            }
+            datasets.push_back(dataset);
+        }
+    }
+
+    for (auto& topology : synthetics) {
+        topology.seed = seed;
+        std::ostringstream name;
+        name << "synthetic-" << topology.asCount << "-p" << topology.peersPerAS << "-x" << topology.prefixCount;
+        fs::path directory = fs::path(workDir) / name.str();
+        fs::create_directories(directory, error);
+
+        std::cout << "Generating " << name.str() << "..." << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        if (error || !topology.write(directory.string())) {
+            std::cerr << "Failed to generate " << name.str() << std::endl;
+            return 1;
+        }
+        std::cout << "Generated in " << std::fixed << std::setprecision(0) << millisecondsSince(start) << "ms"
+                  << std::endl;
+
+        datasets.push_back({name.str(), (directory / "relationships.txt").string(), (directory / "anns.csv").string(),
+                            (directory / "rov_asns.csv").string()});
+    }
+
+    if (datasets.empty()) {
+        std::cerr << "Nothing to benchmark: no bench datasets found and no --synthetic topology given" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream results;
+    if (!resultsFile.empty()) {
+        bool newFile = !fs::exists(resultsFile) || fs::file_size(resultsFile, error) == 0;
+        results.open(resultsFile, std::ios::app);
+        if (!results.is_open()) {
+            std::cerr << "Error opening results file: " << resultsFile << std::endl;
+            return 1;
+        }
+        if (newFile) {
+            results << "dataset,engine,threads,ases,routes,stage,repetitions,mean_ms,stddev_ms,min_ms,max_ms\n";
+        }
+    }
+
+    // Implicit stubs change what is measured, so they are part of the engine label
+    std::string engineName = engine == PropagationEngine::PULL ? "pull" : "push";
+    if (implicitStubs) engineName += "+implicit-stubs";
+    std::cout << repetitions << " repetition(s), " << threads << " thread(s), " << engineName << " engine"
+              << std::endl;
+
+    for (const auto& dataset : datasets) {
+        std::cout << "\n" << dataset.name << std::endl;
+        std::string outputFile = (fs::path(workDir) / (dataset.name + ".ribs.csv")).string();
+
+        std::vector<std::vector<double>> samples(STAGE_COUNT);
+        std::vector<double> stageTimes(STAGE_COUNT);
+        size_t nodeCount = 0;
+        size_t routeCount = 0;
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            if (!runOnce(dataset, threads, engine, implicitStubs, outputFile, stageTimes, nodeCount, routeCount)) {
+                std::cerr << "Run failed for " << dataset.name << std::endl;
+                return 1;
+            }
+            for (size_t stage = 0; stage < STAGE_COUNT; stage++) {
+                samples[stage].push_back(stageTimes[stage]);
+            }
+        }
+        fs::remove(outputFile, error);
+
+        std::cout << "  " << nodeCount << " ASes, " << routeCount << " routes" << std::endl;
+        std::cout << "  " << std::left << std::setw(10) << "stage" << std::right << std::setw(12) << "mean ms"
+                  << std::setw(12) << "stddev" << std::setw(12) << "min" << std::setw(12) << "max" << std::endl;
+        for (size_t stage = 0; stage < STAGE_COUNT; stage++) {
+            Summary summary = summarize(samples[stage]);
+            std::cout << "  " << std::left << std::setw(10) << STAGES[stage] << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << summary.mean << std::setw(12) << summary.stddev
+                      << std::setw(12) << summary.min << std::setw(12) << summary.max << std::endl;
+            if (results.is_open()) {
+                results << dataset.name << "," << engineName << "," << threads << "," << nodeCount << ","
+                        << routeCount << "," << STAGES[stage] << "," << repetitions << "," << std::fixed
+                        << std::setprecision(3) << summary.mean << "," << summary.stddev << "," << summary.min
+                        << "," << summary.max << "\n";
+            }
+        }
+    }
+
+    if (results.is_open() && !results.good()) {
+        std::cerr << "Error writing results file: " << resultsFile << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,20 +1,60 @@
 #include "ASGraph.h"
+#include "HijackScenario.h"
+#include "Profiler.h"
+#include "ScenarioBatch.h"
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <set>
 
 void printUsage(const char* programName) {
-    std::cerr << "Usage: " << programName << " --relationships <file> --announcements <file> --rov-asns <file>" << std::endl;
+    std::cerr << "Usage: " << programName << " (--relationships <file> | --load-topology <file>) --announcements <file> --rov-asns <file> [options]" << std::endl;
     std::cerr << "  --relationships: CAIDA AS relationship file" << std::endl;
+    std::cerr << "  --load-topology: binary topology snapshot written by --save-topology" << std::endl;
+    std::cerr << "  --save-topology: write a topology snapshot after flattening (announcements and ROV ASNs become optional)" << std::endl;
     std::cerr << "  --announcements: CSV file with announcements (asn,prefix,rov_invalid)" << std::endl;
     std::cerr << "  --rov-asns: CSV file with ROV-enabled ASNs" << std::endl;
+    std::cerr << "  --threads: worker threads for propagation (default 1)" << std::endl;
+    std::cerr << "  --prefix-shards: propagate N disjoint prefix ranges concurrently, each with --threads workers (default 1; threads x shards <= 256)" << std::endl;
+    std::cerr << "  --engine: push (receive queues, default) or pull (receivers read neighbor RIBs)" << std::endl;
+    std::cerr << "  --output-format: csv (default) or bin (columnar; convert with ribs_to_csv)" << std::endl;
+    std::cerr << "  --output: output file (default ribs.csv, or ribs.bin for --output-format bin)" << std::endl;
+    std::cerr << "  --delta: CSV of seed/ROV changes (action,asn,prefix,rov_invalid) applied incrementally after propagation" << std::endl;
+    std::cerr << "  --scenarios: CSV manifest (announcements,rov_asns,output) run over one topology instead of --announcements/--rov-asns" << std::endl;
+    std::cerr << "  --concurrent-scenarios: scenarios to run at once in batch mode, each with --threads workers (default 1)" << std::endl;
+    std::cerr << "  --implicit-stubs: keep no RIB for single-homed stub ASes; derive their routes from the provider at output" << std::endl;
+    std::cerr << "  --memory-budget: MB of RIBs to hold before finished ones are spilled to <output>.spill (CSV output only; uses the pull engine)" << std::endl;
+    std::cerr << "  --hijack: <victim_asn>,<attacker_asn> to count who each AS routes to instead of writing RIBs "
+                 "(--output then names an optional summary CSV)" << std::endl;
+    std::cerr << "  --hijack-type: subprefix (default), prefix, or leak (the attacker re-exports the victim's route)" << std::endl;
+    std::cerr << "  --hijack-prefix: prefix the victim announces (default 1.2.0.0/16)" << std::endl;
+    std::cerr << "  --hijack-subprefix: prefix a subprefix attacker announces (default 1.2.3.0/24)" << std::endl;
+    std::cerr << "  --stats: print per-phase timings, route counters and peak memory" << std::endl;
+    std::cerr << "  --profile-json: write the same profile as JSON to a file" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     std::string relationshipsFile;
     std::string announcementsFile;
     std::string rovASNsFile;
+    std::string loadTopologyFile;
+    std::string saveTopologyFile;
+    int threads = 1;
+    int prefixShards = 1;
+    PropagationEngine engine = PropagationEngine::PUSH;
+    bool engineGiven = false;
+    bool binaryOutput = false;
+    std::string outputFile;
+    std::string scenariosFile;
+    std::string deltaFile;
+    int concurrentScenarios = 1;
+    bool implicitStubs = false;
+    long memoryBudgetMB = -1;  // unset: never spill
+    bool hijackMode = false;
+    HijackScenario hijack;
+    bool printStats = false;
+    std::string profileFile;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -24,6 +64,96 @@ int main(int argc, char* argv[]) {
             announcementsFile = argv[++i];
         } else if (strcmp(argv[i], "--rov-asns") == 0 && i + 1 < argc) {
             rovASNsFile = argv[++i];
+        } else if (strcmp(argv[i], "--load-topology") == 0 && i + 1 < argc) {
+            loadTopologyFile = argv[++i];
+        } else if (strcmp(argv[i], "--save-topology") == 0 && i + 1 < argc) {
+            saveTopologyFile = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) {
+                std::cerr << "Error: --threads must be at least 1" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--prefix-shards") == 0 && i + 1 < argc) {
+            prefixShards = atoi(argv[++i]);
+            if (prefixShards < 1) {
+                std::cerr << "Error: --prefix-shards must be at least 1" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            engineGiven = true;
+            if (strcmp(name, "pull") == 0) {
+                engine = PropagationEngine::PULL;
+            } else if (strcmp(name, "push") == 0) {
+                engine = PropagationEngine::PUSH;
+            } else {
+                std::cerr << "Error: unknown engine: " << name << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--output-format") == 0 && i + 1 < argc) {
+            const char* format = argv[++i];
+            if (strcmp(format, "csv") == 0) {
+                binaryOutput = false;
+            } else if (strcmp(format, "bin") == 0) {
+                binaryOutput = true;
+            } else {
+                std::cerr << "Error: unknown output format: " << format << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (strcmp(argv[i], "--delta") == 0 && i + 1 < argc) {
+            deltaFile = argv[++i];
+        } else if (strcmp(argv[i], "--scenarios") == 0 && i + 1 < argc) {
+            scenariosFile = argv[++i];
+        } else if (strcmp(argv[i], "--concurrent-scenarios") == 0 && i + 1 < argc) {
+            concurrentScenarios = atoi(argv[++i]);
+            if (concurrentScenarios < 1) {
+                std::cerr << "Error: --concurrent-scenarios must be at least 1" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--implicit-stubs") == 0) {
+            implicitStubs = true;
+        } else if (strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc) {
+            memoryBudgetMB = atol(argv[++i]);
+            if (memoryBudgetMB < 0) {
+                std::cerr << "Error: --memory-budget must be at least 0" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--hijack") == 0 && i + 1 < argc) {
+            const char* pair = argv[++i];
+            const char* comma = strchr(pair, ',');
+            hijack.victimASN = atoi(pair);
+            hijack.attackerASN = comma ? atoi(comma + 1) : 0;
+            if (hijack.victimASN <= 0 || hijack.attackerASN <= 0) {
+                std::cerr << "Error: --hijack expects <victim_asn>,<attacker_asn>" << std::endl;
+                return 1;
+            }
+            hijackMode = true;
+        } else if (strcmp(argv[i], "--hijack-type") == 0 && i + 1 < argc) {
+            const char* type = argv[++i];
+            if (strcmp(type, "subprefix") == 0) {
+                hijack.type = HijackType::SUBPREFIX;
+            } else if (strcmp(type, "prefix") == 0) {
+                hijack.type = HijackType::PREFIX;
+            } else if (strcmp(type, "leak") == 0) {
+                hijack.type = HijackType::LEAK;
+            } else {
+                std::cerr << "Error: unknown hijack type: " << type << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--hijack-prefix") == 0 && i + 1 < argc) {
+            hijack.prefix = argv[++i];
+        } else if (strcmp(argv[i], "--hijack-subprefix") == 0 && i + 1 < argc) {
+            hijack.subprefix = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            printStats = true;
+        } else if (strcmp(argv[i], "--profile-json") == 0 && i + 1 < argc) {
+            profileFile = argv[++i];
         } else {
             std::cerr << "Unknown argument: " << argv[i] << std::endl;
             printUsage(argv[0]);
@@ -32,73 +162,244 @@ int main(int argc, char* argv[]) {
     }
 
     // Check required arguments
-    if (relationshipsFile.empty() || announcementsFile.empty() || rovASNsFile.empty()) {
-        std::cerr << "Error: All three arguments are required." << std::endl;
+    if (relationshipsFile.empty() == loadTopologyFile.empty()) {
+        std::cerr << "Error: Exactly one of --relationships or --load-topology is required." << std::endl;
         printUsage(argv[0]);
         return 1;
     }
 
-    ASGraph graph;
+    bool batchMode = !scenariosFile.empty();
+    bool profiling = printStats || !profileFile.empty();
+    if (batchMode && (!announcementsFile.empty() || !rovASNsFile.empty() || !outputFile.empty() || !deltaFile.empty() ||
+                      profiling)) {
+        std::cerr << "Error: --scenarios cannot be combined with --announcements, --rov-asns, --output, --delta, "
+                     "--stats or --profile-json." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
 
-    // Load relationships
-    std::cout << "Loading AS relationships from: " << relationshipsFile << std::endl;
-    auto start = std::chrono::high_resolution_clock::now();
+    ScenarioBatch batch;
+    if (batchMode && !batch.loadManifest(scenariosFile)) {
+        return 1;
+    }
 
-    if (!graph.loadFromFile(relationshipsFile)) {
-        std::cerr << "Failed to load relationships file" << std::endl;
+    // Spilled rows are spliced back into ribs.csv, and the routing state they
+    // came from is gone, so nothing can run on it afterwards
+    if (memoryBudgetMB >= 0 && (batchMode || binaryOutput || !deltaFile.empty() || prefixShards > 1)) {
+        std::cerr << "Error: --memory-budget cannot be combined with --scenarios, --output-format bin, --delta "
+                     "or --prefix-shards." << std::endl;
+        printUsage(argv[0]);
         return 1;
     }
+    // Only pull bounds path memory along with the RIBs, so a budget selects it
+    if (memoryBudgetMB >= 0) {
+        if (engineGiven && engine == PropagationEngine::PUSH) {
+            std::cerr << "Error: --memory-budget runs the pull engine; it cannot be combined with --engine push."
+                      << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        engine = PropagationEngine::PULL;
+    }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Loaded " << graph.nodes.size() << " nodes in " << duration.count() << "ms" << std::endl;
+    // A hijack seeds its own two announcements and writes no RIBs
+    if (hijackMode && (batchMode || !announcementsFile.empty() || binaryOutput || !deltaFile.empty() ||
+                       memoryBudgetMB >= 0)) {
+        std::cerr << "Error: --hijack cannot be combined with --scenarios, --announcements, --output-format bin, "
+                     "--delta or --memory-budget." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (hijackMode && rovASNsFile.empty()) {
+        std::cerr << "Error: --rov-asns is required." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
 
-    // Check for cycles
-    std::cout << "Checking for cycles in AS relationships..." << std::endl;
-    if (graph.hasProviderCycle()) {
-        std::cerr << "ERROR: Provider cycle detected in AS relationships!" << std::endl;
+    bool snapshotOnly = !batchMode && !saveTopologyFile.empty() && announcementsFile.empty() && rovASNsFile.empty();
+    if (!batchMode && !hijackMode && !snapshotOnly && (announcementsFile.empty() || rovASNsFile.empty())) {
+        std::cerr << "Error: --announcements and --rov-asns are required." << std::endl;
+        printUsage(argv[0]);
         return 1;
     }
-    
-    if (graph.hasCustomerCycle()) {
-        std::cerr << "ERROR: Customer cycle detected in AS relationships!" << std::endl;
+
+    ASGraph graph;
+    if (!graph.setThreadCount(threads) || !graph.setPrefixShards(prefixShards)) {
         return 1;
     }
+    graph.setImplicitStubs(implicitStubs);
+    graph.engine = engine;
+    if (outputFile.empty() && !hijackMode) {
+        outputFile = binaryOutput ? "ribs.bin" : "ribs.csv";
+    }
+    if (memoryBudgetMB >= 0) {
+        graph.setMemoryBudget(static_cast<size_t>(memoryBudgetMB) << 20, outputFile + ".spill");
+    }
+
+    // Phases are only recorded when profiling; the graph adds its own
+    // per-rank phases under "propagate" and "delta"
+    Profiler profiler;
+    if (profiling) {
+        graph.profiler = &profiler;
+    }
+    auto beginPhase = [&](const char* name) {
+        if (profiling) profiler.begin(name);
+    };
+    auto endPhase = [&]() {
+        if (profiling) profiler.end();
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto end = start;
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    if (!loadTopologyFile.empty()) {
+        // Snapshots were validated and flattened when they were saved
+        std::cout << "Loading topology snapshot from: " << loadTopologyFile << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+        beginPhase("load_topology");
+        if (!graph.loadTopology(loadTopologyFile)) {
+            std::cerr << "Failed to load topology snapshot" << std::endl;
+            return 1;
+        }
+        endPhase();
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Loaded " << graph.nodes.size() << " nodes (" << graph.propagationRanks.size()
+                  << " ranks) in " << duration.count() << "ms" << std::endl;
+    } else {
+        // Load relationships
+        std::cout << "Loading AS relationships from: " << relationshipsFile << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+
+        beginPhase("load_relationships");
+        if (!graph.loadFromFile(relationshipsFile)) {
+            std::cerr << "Failed to load relationships file" << std::endl;
+            return 1;
+        }
+        endPhase();
+
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Loaded " << graph.nodes.size() << " nodes in " << duration.count() << "ms" << std::endl;
+
+        // Check for cycles
+        std::cout << "Checking for cycles in AS relationships..." << std::endl;
+        std::vector<int> cycle;
+        beginPhase("cycle_check");
+        if (graph.findProviderCycle(cycle)) {
+            std::cerr << "ERROR: Provider cycle detected in AS relationships!" << std::endl;
+            std::cerr << "Cycle (each AS is a provider of the next):";
+            for (size_t i = 0; i < cycle.size(); i++) {
+                std::cerr << (i == 0 ? " " : " -> ") << cycle[i];
+            }
+            std::cerr << std::endl;
+            return 1;
+        }
+        endPhase();
     
-    std::cout << "No cycles detected. Topology is valid." << std::endl;
+        std::cout << "No cycles detected. Topology is valid." << std::endl;
 
-    // Flatten graph for propagation
-    std::cout << "Flattening graph for BGP propagation..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-    graph.flattenGraph();
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Graph flattened into " << graph.propagationRanks.size() << " ranks in " << duration.count() << "ms" << std::endl;
+        // Flatten graph for propagation
+        std::cout << "Flattening graph for BGP propagation..." << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+        beginPhase("flatten");
+        graph.flattenGraph();
+        endPhase();
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Graph flattened into " << graph.propagationRanks.size() << " ranks in " << duration.count() << "ms" << std::endl;
+    }
+
+    if (!saveTopologyFile.empty()) {
+        std::cout << "Saving topology snapshot to: " << saveTopologyFile << std::endl;
+        if (!graph.saveTopology(saveTopologyFile)) {
+            std::cerr << "Failed to save topology snapshot" << std::endl;
+            return 1;
+        }
+        if (snapshotOnly) {
+            return 0;
+        }
+    }
+
+    if (batchMode) {
+        batch.concurrentScenarios = concurrentScenarios;
+        batch.threadsPerScenario = threads;
+        batch.prefixShards = prefixShards;
+        batch.engine = engine;
+        batch.binaryOutput = binaryOutput;
+        batch.implicitStubs = implicitStubs;
+
+        std::cout << "Running " << batch.scenarios.size() << " scenario(s), " << concurrentScenarios
+                  << " at a time..." << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+        bool ok = batch.run(graph);
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Batch completed in " << duration.count() << "ms" << std::endl;
+        return ok ? 0 : 1;
+    }
 
     // Load ROV ASNs
     std::cout << "Loading ROV-enabled ASNs from: " << rovASNsFile << std::endl;
     std::set<int> rovASNs;
+    beginPhase("load_rov_asns");
     if (!graph.loadROVASNs(rovASNsFile, rovASNs)) {
         std::cerr << "Failed to load ROV ASNs file" << std::endl;
         return 1;
     }
+    endPhase();
     std::cout << "Loaded " << rovASNs.size() << " ROV-enabled ASNs" << std::endl;
 
+    if (hijackMode) {
+        std::cout << "Propagating hijack with " << graph.threadCount() << " thread(s)..." << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+        beginPhase("propagate");
+        bool ok = hijack.run(graph, rovASNs);
+        endPhase();
+        if (!ok) {
+            return 1;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Hijack propagated and counted in " << duration.count() << "ms" << std::endl;
+
+        hijack.printSummary();
+        if (!outputFile.empty()) {
+            std::cout << "Writing hijack summary to: " << outputFile << std::endl;
+            if (!hijack.writeCSV(outputFile)) {
+                return 1;
+            }
+        }
+        if (printStats) {
+            profiler.printSummary();
+        }
+        if (!profileFile.empty() &&
+            !profiler.writeJSON(profileFile, engine == PropagationEngine::PULL ? "pull" : "push", graph.threadCount())) {
+            return 1;
+        }
+        return 0;
+    }
+
     // Initialize BGP policies (some with ROV)
     std::cout << "Initializing BGP policies..." << std::endl;
+    beginPhase("init_policies");
     graph.initializeBGPPolicies(rovASNs);
+    endPhase();
 
     // Load and seed announcements
     std::cout << "Loading announcements from: " << announcementsFile << std::endl;
+    beginPhase("seed_announcements");
     if (!graph.loadAnnouncementsFromCSV(announcementsFile)) {
         std::cerr << "Failed to load announcements file" << std::endl;
         return 1;
     }
+    endPhase();
 
     // Count seeded announcements
     int totalSeededAnnouncements = 0;
-    for (const auto& pair : graph.nodes) {
-        BGP* bgp = dynamic_cast<BGP*>(pair.second->policy.get());
+    for (const auto& node : graph.nodes) {
+        BGP* bgp = dynamic_cast<BGP*>(node.policy.get());
         if (bgp) {
             totalSeededAnnouncements += bgp->localRIB.size();
         }
@@ -106,29 +407,64 @@ int main(int argc, char* argv[]) {
     std::cout << "Seeded " << totalSeededAnnouncements << " announcements" << std::endl;
 
     // Propagate announcements
-    std::cout << "Propagating BGP announcements..." << std::endl;
+    std::cout << "Propagating BGP announcements with " << graph.threadCount() << " thread(s)..." << std::endl;
     start = std::chrono::high_resolution_clock::now();
-    graph.propagateAnnouncements();
+    beginPhase("propagate");
+    if (!graph.propagateAnnouncements()) {
+        return 1;
+    }
+    endPhase();
     end = std::chrono::high_resolution_clock::now();
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     std::cout << "BGP propagation completed in " << duration.count() << "ms" << std::endl;
+    if (graph.spilledRoutes() > 0) {
+        std::cout << "Spilled " << graph.spilledRoutes() << " routes to " << outputFile << ".spill" << std::endl;
+    }
+
+    if (!deltaFile.empty()) {
+        std::cout << "Applying delta from: " << deltaFile << std::endl;
+        RouteDelta delta;
+        if (!delta.loadFromCSV(deltaFile)) {
+            std::cerr << "Failed to load delta file" << std::endl;
+            return 1;
+        }
+        start = std::chrono::high_resolution_clock::now();
+        beginPhase("delta");
+        bool applied = graph.applyDelta(delta);
+        if (graph.paths.full()) {
+            return 1;
+        }
+        if (!applied) {
+            std::cerr << "Warning: some delta entries were skipped" << std::endl;
+        }
+        endPhase();
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Incremental re-propagation completed in " << duration.count() << "ms" << std::endl;
+    }
 
     // Output results
-    std::string outputFile = "ribs.csv";
     std::cout << "Writing results to: " << outputFile << std::endl;
-    graph.outputToCSV(outputFile);
-
-    // Summary statistics
-    int totalRoutes = 0;
-    for (const auto& pair : graph.nodes) {
-        BGP* bgp = dynamic_cast<BGP*>(pair.second->policy.get());
-        if (bgp) {
-            totalRoutes += bgp->localRIB.size();
+    beginPhase("output");
+    if (binaryOutput) {
+        if (!graph.outputToBinary(outputFile)) {
+            return 1;
         }
+    } else if (!graph.outputToCSV(outputFile)) {
+        return 1;
     }
+    endPhase();
 
     std::cout << "Simulation complete!" << std::endl;
-    std::cout << "Total routes in all RIBs: " << totalRoutes << std::endl;
+    std::cout << "Total routes in all RIBs: " << graph.routeCount() << std::endl;
+
+    if (printStats) {
+        profiler.printSummary();
+    }
+    if (!profileFile.empty() &&
+        !profiler.writeJSON(profileFile, engine == PropagationEngine::PULL ? "pull" : "push", graph.threadCount())) {
+        return 1;
+    }
 
     return 0;
 }
@@ -27,19 +27,31 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\nChecking for cycles..." << std::endl;
 
+    // Provider and customer cycles are the same cycles walked in opposite
+    // directions, so one pass answers both
     start = std::chrono::high_resolution_clock::now();
-    bool providerCycle = graph.hasProviderCycle();
+    std::vector<int> cycle;
+    bool found = graph.findProviderCycle(cycle);
     end = std::chrono::high_resolution_clock::now();
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Provider cycle check: " << (providerCycle ? "FOUND" : "NONE")
+    std::cout << "Provider/customer cycle check: " << (found ? "FOUND" : "NONE")
               << " (" << duration.count() << "ms)" << std::endl;
+    if (found) {
+        std::cout << "Cycle (each AS is a provider of the next):";
+        for (size_t i = 0; i < cycle.size(); i++) {
+            std::cout << (i == 0 ? " " : " -> ") << cycle[i];
+        }
+        std::cout << std::endl;
+        return 0;
+    }
 
+    std::cout << "\nFlattening graph..." << std::endl;
     start = std::chrono::high_resolution_clock::now();
-    bool customerCycle = graph.hasCustomerCycle();
+    graph.flattenGraph();
     end = std::chrono::high_resolution_clock::now();
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Customer cycle check: " << (customerCycle ? "FOUND" : "NONE")
-              << " (" << duration.count() << "ms)" << std::endl;
+    std::cout << "Flattened in " << duration.count() << "ms" << std::endl;
+    graph.printRankStats();
 
     return 0;
 }
@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+#include "RibFormat.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Converts a binary RIB dump (bgp_simulator --output-format bin) back into
+// the exact ribs.csv text the simulator would have written.
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <ribs.bin> <ribs.csv>" << std::endl;
+        return 1;
+    }
+    std::string inputFile = argv[1];
+    std::string outputFile = argv[2];
+
+    MappedFile input;
+    if (!input.open(inputFile)) {
+        std::cerr << "Error opening binary RIB file: " << inputFile << std::endl;
+        return 1;
+    }
+
+    RibFileHeader header;
+    if (input.size() < sizeof(header)) {
+        std::cerr << "Binary RIB file is truncated: " << inputFile << std::endl;
+        return 1;
+    }
+    std::memcpy(&header, input.begin(), sizeof(header));
+    if (std::memcmp(header.magic, RIB_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "Not a binary RIB file: " << inputFile << std::endl;
+        return 1;
+    }
+    if (header.version != RIB_FILE_VERSION) {
+        std::cerr << "Unsupported binary RIB version " << header.version
+                  << " (expected " << RIB_FILE_VERSION << "): " << inputFile << std::endl;
+        return 1;
+    }
+
+    // Each count is bounded by the bytes left before it is multiplied, so a
+    // corrupt header cannot wrap the size check
+    uint64_t remaining = input.size() - sizeof(header);
+    auto take = [&remaining](uint64_t count, uint64_t width) {
+        if (count > remaining / width) return false;
+        remaining -= count * width;
+        return true;
+    };
+    bool sized = take(header.rowCount, 12) && take(header.pathCount, 8) &&
+                 take(static_cast<uint64_t>(header.prefixCount) + 1, 4) && take(header.stringBytes, 1);
+    if (!sized || remaining != 0 || header.pathCount == 0) {
+        std::cerr << "Binary RIB file has inconsistent sizes: " << inputFile << std::endl;
+        return 1;
+    }
+
+    // Every section is 4-byte aligned, so the columns are read in place
+    const char* cursor = input.begin() + sizeof(header);
+    const int32_t* asns = reinterpret_cast<const int32_t*>(cursor);
+    const uint32_t* prefixIds = reinterpret_cast<const uint32_t*>(asns + header.rowCount);
+    const uint32_t* pathIds = prefixIds + header.rowCount;
+    const int32_t* pathHeads = reinterpret_cast<const int32_t*>(pathIds + header.rowCount);
+    const uint32_t* pathParents = reinterpret_cast<const uint32_t*>(pathHeads + header.pathCount);
+    const uint32_t* stringOffsets = pathParents + header.pathCount;
+    const char* strings = reinterpret_cast<const char*>(stringOffsets + header.prefixCount + 1);
+
+    for (uint32_t i = 0; i < header.prefixCount; i++) {
+        if (stringOffsets[i] > stringOffsets[i + 1]) {
+            std::cerr << "Binary RIB file has a corrupt string table: " << inputFile << std::endl;
+            return 1;
+        }
+    }
+    if (stringOffsets[0] != 0 || stringOffsets[header.prefixCount] != header.stringBytes) {
+        std::cerr << "Binary RIB file has a corrupt string table: " << inputFile << std::endl;
+        return 1;
+    }
+    for (uint64_t i = 0; i < header.pathCount; i++) {
+        if (pathParents[i] >= header.pathCount) {
+            std::cerr << "Binary RIB file has a corrupt path table: " << inputFile << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error opening output file: " << outputFile << std::endl;
+        return 1;
+    }
+    output << RIB_CSV_HEADER;
+
+    const size_t flushThreshold = 1 << 22;
+    std::string out;
+    out.reserve(flushThreshold + 4096);
+    std::vector<int> hops;
+
+    for (uint64_t row = 0; row < header.rowCount; row++) {
+        if (prefixIds[row] >= header.prefixCount || pathIds[row] >= header.pathCount) {
+            std::cerr << "Binary RIB file has an out-of-range row " << row << ": " << inputFile << std::endl;
+            return 1;
+        }
+
+        // A well-formed path ends at the empty path; anything longer than
+        // the path table loops
+        hops.clear();
+        for (uint32_t path = pathIds[row]; path != 0; path = pathParents[path]) {
+            if (hops.size() == header.pathCount) {
+                std::cerr << "Binary RIB file has a cyclic path at row " << row << ": " << inputFile << std::endl;
+                return 1;
+            }
+            hops.push_back(pathHeads[path]);
+        }
+
+        uint32_t prefixId = prefixIds[row];
+        size_t prefixLength = stringOffsets[prefixId + 1] - stringOffsets[prefixId];
+        size_t used = out.size();
+        out.resize(used + maxRibRowSize(prefixLength, static_cast<uint32_t>(hops.size())));
+        char* end = formatRibRow(&out[used], asns[row], strings + stringOffsets[prefixId], prefixLength,
+                                 hops.data(), static_cast<uint32_t>(hops.size()));
+        out.resize(end - out.data());
+
+        if (out.size() >= flushThreshold) {
+            output.write(out.data(), out.size());
+            out.clear();
+        }
+    }
+    output.write(out.data(), out.size());
+
+    if (!output.good()) {
+        std::cerr << "Error writing output file: " << outputFile << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << header.rowCount << " routes to " << outputFile << std::endl;
+    return 0;
+}
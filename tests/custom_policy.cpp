@@ -0,0 +1,78 @@
+#include "ASGraph.h"
+#include "Policy.h"
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+
+// Regression check for the virtual policy path: every node gets a subclass
+// of its built-in policy that changes nothing but counts the calls, so the
+// engines must dispatch through Policy and still produce the baseline RIBs.
+// Usage: custom_policy <relationships> <announcements> <rov_asns> <push|pull> <threads> <output>
+
+namespace {
+
+std::atomic<size_t> offered{0};
+std::atomic<size_t> processed{0};
+
+template <class Base>
+class Counted : public Base {
+public:
+    void addToReceivedQueue(PrefixId prefixId, const Announcement& announcement) override {
+        offered++;
+        Base::addToReceivedQueue(prefixId, announcement);
+    }
+
+    void processAnnouncements(int currentASN, PathShard& paths) override {
+        processed++;
+        Base::processAnnouncements(currentASN, paths);
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 7) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <relationships> <announcements> <rov_asns> <push|pull> <threads> <output>" << std::endl;
+        return 1;
+    }
+    std::string engine = argv[4];
+    if (engine != "push" && engine != "pull") {
+        std::cerr << "Unknown engine: " << engine << std::endl;
+        return 1;
+    }
+
+    ASGraph graph;
+    if (!graph.setThreadCount(static_cast<unsigned>(std::stoul(argv[5])))) return 1;
+    graph.engine = engine == "pull" ? PropagationEngine::PULL : PropagationEngine::PUSH;
+    if (!graph.loadFromFile(argv[1])) return 1;
+    graph.flattenGraph();
+
+    std::set<int> rovASNs;
+    if (!graph.loadROVASNs(argv[3], rovASNs)) return 1;
+    graph.initializeBGPPolicies(rovASNs);
+    for (auto& node : graph.nodes) {
+        const BGP* bgp = dynamic_cast<const BGP*>(node.policy.get());
+        if (!bgp) continue;
+        if (bgp->dropsInvalid()) {
+            node.policy = std::make_unique<Counted<ROV>>();
+        } else {
+            node.policy = std::make_unique<Counted<BGP>>();
+        }
+    }
+    graph.classifyPolicies();
+
+    if (!graph.loadAnnouncementsFromCSV(argv[2]) || !graph.propagateAnnouncements() ||
+        !graph.outputToCSV(argv[6])) {
+        return 1;
+    }
+
+    std::cout << "Offered " << offered << " announcements, processed " << processed << " queues" << std::endl;
+    if (offered == 0 || processed == 0) {
+        std::cerr << "The custom policies were never called" << std::endl;
+        return 1;
+    }
+    return 0;
+}
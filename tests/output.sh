@@ -0,0 +1,99 @@
+#!/bin/bash
+
+# Output check: runs one tool on the data in tests/data and checks its exit
+# code and the lines it reports
+# Usage: tests/output.sh <check> <build_dir>
+# Checks: cycle-report, rank-stats, profile-json
+
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <check> <build_dir>"
+    exit 1
+fi
+
+CHECK="$1"
+BUILD="$2"
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+DATA="$ROOT/tests/data"
+WORK="$BUILD/output/$CHECK"
+LOG="$WORK/output.log"
+
+rm -rf "$WORK"
+mkdir -p "$WORK"
+
+# run <expected exit code> <command...>: stdout and stderr both go to $LOG
+run() {
+    local expected="$1"
+    shift
+    "$@" > "$LOG" 2>&1
+    local status=$?
+    if [ "$status" -ne "$expected" ]; then
+        cat "$LOG"
+        echo "Exit code $status, expected $expected"
+        exit 1
+    fi
+}
+
+# expect <line> [file]: the whole line must appear in the file, $LOG by default
+expect() {
+    local file="${2:-$LOG}"
+    if ! grep -qxF -- "$1" "$file"; then
+        cat "$file"
+        echo "Missing line: $1"
+        exit 1
+    fi
+}
+
+case "$CHECK" in
+    cycle-report)
+        # The simulator refuses a topology with a provider cycle and names
+        # the ASes on it; graph_stats reports the same cycle
+        run 1 "$BUILD/bgp_simulator" --relationships "$DATA/cycle.txt" --announcements "$DATA/anns.csv" \
+            --rov-asns "$DATA/rov_asns.csv" --output "$WORK/ribs.csv"
+        expect "ERROR: Provider cycle detected in AS relationships!"
+        expect "Cycle (each AS is a provider of the next): 2 -> 3 -> 4 -> 2"
+        [ ! -e "$WORK/ribs.csv" ] || { echo "RIBs were written for a cyclic topology"; exit 1; }
+
+        run 0 "$BUILD/graph_stats" "$DATA/cycle.txt"
+        expect "Cycle (each AS is a provider of the next): 2 -> 3 -> 4 -> 2"
+        ;;
+    rank-stats)
+        # Each AS sits one rank above its highest customer; the counts were
+        # checked against an independent longest-path computation
+        run 0 "$BUILD/graph_stats" "$DATA/relationships.txt"
+        expect "Propagation ranks: 11"
+        expect "Mean ASes per rank: 16"
+        expect "Largest rank: 0 (113 ASes)"
+        expect "Smallest rank: 10 (1 ASes)"
+        expect "ASes per rank: 113, 24, 13, 9, 6, 2, 2, 4, 4, 2, 1"
+        ;;
+    profile-json)
+        # Every route sent is dropped, accepted, replaced or rejected, and the
+        # 10 seeded routes plus the accepted ones are the 1112 rows written.
+        # Pull stages its routes, so it reports displaced ones as rejected.
+        JSON="$WORK/profile.json"
+        run 0 "$BUILD/bgp_simulator" --relationships "$DATA/relationships.txt" --announcements "$DATA/anns.csv" \
+            --rov-asns "$DATA/rov_asns.csv" --output "$WORK/ribs.csv" --profile-json "$JSON"
+        expect '  "engine": "push",' "$JSON"
+        expect '  "threads": 1,' "$JSON"
+        grep -q '^    {"name": "up.rank0", "depth": 1, ' "$JSON" || { echo "No up.rank0 phase"; exit 1; }
+        grep -q '^    {"name": "across", .*, "edges": 89}' "$JSON" || { echo "No across phase over 89 edges"; exit 1; }
+        expect '  "totals": {"sent": 2052, "dropped_by_rov": 71, "accepted": 1102, "replaced": 189, "rejected": 690}' "$JSON"
+
+        run 0 "$BUILD/bgp_simulator" --relationships "$DATA/relationships.txt" --announcements "$DATA/anns.csv" \
+            --rov-asns "$DATA/rov_asns.csv" --output "$WORK/ribs.csv" --engine pull --threads 3 \
+            --profile-json "$JSON"
+        expect "Total routes in all RIBs: 1112"
+        expect '  "engine": "pull",' "$JSON"
+        expect '  "threads": 3,' "$JSON"
+        expect '  "totals": {"sent": 2052, "dropped_by_rov": 71, "accepted": 1102, "replaced": 0, "rejected": 879}' "$JSON"
+        if command -v python3 > /dev/null; then
+            python3 -m json.tool "$JSON" > /dev/null || { echo "$JSON is not valid JSON"; exit 1; }
+        fi
+        ;;
+    *)
+        echo "Unknown check: $CHECK"
+        exit 1
+        ;;
+esac
+
+echo "$CHECK: OK"
@@ -0,0 +1,114 @@
+#!/bin/bash
+
+# Regression check: runs one engine/mode on the small topology in tests/data
+# and compares its RIBs with the baseline ribs.csv there
+# Usage: tests/regression.sh <mode> <build_dir>
+# Modes: push, threads, pull, pull-threads, snapshot, binary, delta,
+#        prefix-shards, implicit-stubs, memory-budget, hijack-prefix,
+#        hijack-subprefix, hijack-leak, custom-push, custom-pull,
+#        custom-pull-threads, batch
+
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <mode> <build_dir>"
+    exit 1
+fi
+
+MODE="$1"
+BUILD="$2"
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+DATA="$ROOT/tests/data"
+WORK="$BUILD/regression/$MODE"
+
+rm -rf "$WORK"
+mkdir -p "$WORK"
+
+ANNOUNCEMENTS=(--announcements "$DATA/anns.csv")
+simulate() {
+    "$BUILD/bgp_simulator" "${ANNOUNCEMENTS[@]}" --rov-asns "$DATA/rov_asns.csv" "$@" \
+        > "$WORK/simulator.log" 2>&1 || { cat "$WORK/simulator.log"; exit 1; }
+}
+
+TOPOLOGY=(--relationships "$DATA/relationships.txt")
+EXPECTED="$DATA/ribs.csv"
+ACTUAL="$WORK/ribs.csv"
+
+case "$MODE" in
+    push)           simulate "${TOPOLOGY[@]}" --output "$ACTUAL" ;;
+    threads)        simulate "${TOPOLOGY[@]}" --threads 3 --output "$ACTUAL" ;;
+    pull)           simulate "${TOPOLOGY[@]}" --engine pull --output "$ACTUAL" ;;
+    pull-threads)   simulate "${TOPOLOGY[@]}" --engine pull --threads 3 --output "$ACTUAL" ;;
+    snapshot)
+        "$BUILD/bgp_simulator" "${TOPOLOGY[@]}" --save-topology "$WORK/topology.bin" > "$WORK/save.log" 2>&1 ||
+            { cat "$WORK/save.log"; exit 1; }
+        simulate --load-topology "$WORK/topology.bin" --output "$ACTUAL"
+        ;;
+    binary)
+        simulate "${TOPOLOGY[@]}" --output-format bin --output "$WORK/ribs.bin"
+        "$BUILD/ribs_to_csv" "$WORK/ribs.bin" "$ACTUAL" || exit 1
+        ;;
+    delta)
+        # Applying delta.csv must give the same RIBs as a full run on the
+        # announcements and ROV ASNs it leads to
+        simulate "${TOPOLOGY[@]}" --delta "$DATA/delta.csv" --output "$ACTUAL"
+        EXPECTED="$DATA/ribs_after_delta.csv"
+        ;;
+    prefix-shards)  simulate "${TOPOLOGY[@]}" --prefix-shards 3 --threads 2 --output "$ACTUAL" ;;
+    implicit-stubs) simulate "${TOPOLOGY[@]}" --implicit-stubs --output "$ACTUAL" ;;
+    memory-budget)
+        # A zero budget spills every RIB as soon as it is finished
+        simulate "${TOPOLOGY[@]}" --memory-budget 0 --output "$ACTUAL"
+        grep -q "^Spilled" "$WORK/simulator.log" || { echo "Nothing was spilled"; exit 1; }
+        ;;
+    hijack-prefix | hijack-subprefix | hijack-leak)
+        # The outcome fractions of one victim/attacker pair, checked against
+        # an independent fixed-point computation when they were recorded
+        TYPE="${MODE#hijack-}"
+        ANNOUNCEMENTS=()
+        simulate "${TOPOLOGY[@]}" --hijack 178323,69822 --hijack-type "$TYPE" --output "$ACTUAL"
+        EXPECTED="$DATA/hijack_$TYPE.csv"
+        ;;
+    custom-push | custom-pull | custom-pull-threads)
+        # Counting subclasses of BGP and ROV take the virtual policy path
+        # and must land on the same RIBs as the built-in kernels
+        ENGINE="${MODE#custom-}"
+        THREADS=1
+        if [ "$ENGINE" = "pull-threads" ]; then ENGINE=pull; THREADS=3; fi
+        "$BUILD/custom_policy" "$DATA/relationships.txt" "$DATA/anns.csv" "$DATA/rov_asns.csv" \
+            "$ENGINE" "$THREADS" "$ACTUAL" > "$WORK/custom.log" 2>&1 || { cat "$WORK/custom.log"; exit 1; }
+        ;;
+    batch)
+        # Concurrent runners with implicit stubs must write what a standalone
+        # run of each scenario writes. The baseline scenario runs twice, so a
+        # runner also reuses its graph after a different scenario.
+        head -n 7 "$DATA/anns.csv" > "$WORK/anns_half.csv"
+        : > "$WORK/rov_none.csv"
+        {
+            echo "announcements,rov_asns,output"
+            echo "$DATA/anns.csv,$DATA/rov_asns.csv,$WORK/batch_0.csv"
+            echo "$DATA/anns.csv,$WORK/rov_none.csv,$WORK/batch_1.csv"
+            echo "$WORK/anns_half.csv,$DATA/rov_asns.csv,$WORK/batch_2.csv"
+            echo "$DATA/anns.csv,$DATA/rov_asns.csv,$WORK/batch_3.csv"
+        } > "$WORK/scenarios.csv"
+        "$BUILD/bgp_simulator" "${TOPOLOGY[@]}" --scenarios "$WORK/scenarios.csv" --concurrent-scenarios 3 \
+            --threads 2 --implicit-stubs > "$WORK/batch.log" 2>&1 || { cat "$WORK/batch.log"; exit 1; }
+
+        ANNOUNCEMENTS=()
+        run=0
+        for scenario in "$DATA/anns.csv $DATA/rov_asns.csv" "$DATA/anns.csv $WORK/rov_none.csv" \
+                        "$WORK/anns_half.csv $DATA/rov_asns.csv"; do
+            read -r anns rov <<< "$scenario"
+            "$BUILD/bgp_simulator" "${TOPOLOGY[@]}" --announcements "$anns" --rov-asns "$rov" --implicit-stubs \
+                --output "$WORK/single_$run.csv" > "$WORK/single.log" 2>&1 || { cat "$WORK/single.log"; exit 1; }
+            "$ROOT/compare_output.sh" "$WORK/single_$run.csv" "$WORK/batch_$run.csv" || exit 1
+            run=$((run + 1))
+        done
+        "$ROOT/compare_output.sh" "$WORK/single_0.csv" "$WORK/batch_3.csv" || exit 1
+        ACTUAL="$WORK/batch_0.csv"
+        ;;
+    *)
+        echo "Unknown mode: $MODE"
+        exit 1
+        ;;
+esac
+
+"$ROOT/compare_output.sh" "$EXPECTED" "$ACTUAL"